@@ -100,7 +100,7 @@ private:
 		}
 
 		// ԪضǰֱƳһ
-		if (StartIndex < Data.Num() / 2 && EndIndex < Data.Num() / 2)
+		if (StartIndex < EndIndex && EndIndex < Data.Num() / 2)
 		{
 			Data.RemoveAt(Data.Num() / 2, Data.Num() - Data.Num() / 2);
 			return;
@@ -115,7 +115,7 @@ private:
 		}
 
 		StartIndex = 0;
-		EndIndex = NewData.Num() - 1;
+		EndIndex = 0;
 		Data = MoveTempIfPossible(NewData);
 	}
 
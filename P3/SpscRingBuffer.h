@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include "../p2/Util.h"
+
+/**
+ * A fixed-size ring buffer for exactly one producer thread and one consumer thread, without locks.
+ *
+ * Head and Tail only ever grow, and index the ring modulo Capacity, which must be a power of two. Each side owns
+ * its own index and only reads the other's: the producer publishes an element by storing Tail with release
+ * semantics, and the consumer sees it by loading Tail with acquire semantics (and likewise the other way round for
+ * freed slots through Head). Each index sits on its own cache line, next to the owner's cached copy of the other
+ * index, so a side only reads the other side's line when its cached copy says the ring looks full (or empty).
+ *
+ * TryPushN and TryPopN move a whole batch for one index update, which is what makes the ring cheap at high rates.
+ */
+template <typename T, std::int32_t Capacity>
+class TSpscRingBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	static constexpr std::uint64_t IndexMask = Capacity - 1;
+
+public:
+	typedef T ElementType;
+
+	TSpscRingBuffer()
+		: Tail(0)
+		, CachedHead(0)
+		, Head(0)
+		, CachedTail(0)
+	{ }
+
+	~TSpscRingBuffer()
+	{
+		const std::uint64_t End = Tail.load(std::memory_order_relaxed);
+		for (std::uint64_t Index = Head.load(std::memory_order_relaxed); Index != End; ++Index)
+		{
+			DestructItem(GetSlot(Index));
+		}
+	}
+
+	TSpscRingBuffer(const TSpscRingBuffer&) = delete;
+	TSpscRingBuffer& operator=(const TSpscRingBuffer&) = delete;
+
+	// Producer methods.
+
+	/**
+	 * Constructs an element in place at the end of the ring. Producer thread only.
+	 *
+	 * @return false if the ring was full.
+	 */
+	template <typename... ArgsType>
+	bool TryEmplace(ArgsType&&... Args)
+	{
+		const std::uint64_t Index = Tail.load(std::memory_order_relaxed);
+		if (Index - CachedHead == Capacity)
+		{
+			CachedHead = Head.load(std::memory_order_acquire);
+			if (Index - CachedHead == Capacity)
+			{
+				return false;
+			}
+		}
+
+		new(GetSlot(Index)) ElementType(std::forward<ArgsType>(Args)...);
+		Tail.store(Index + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(const ElementType& Item)
+	{
+		return TryEmplace(Item);
+	}
+
+	bool TryPush(ElementType&& Item)
+	{
+		return TryEmplace(MoveTempIfPossible(Item));
+	}
+
+	/**
+	 * Copies as many of Items as fit to the end of the ring, and publishes them together. Producer thread only.
+	 *
+	 * @return the number of items pushed, from the start of Items.
+	 */
+	std::int32_t TryPushN(const ElementType* Items, std::int32_t Count)
+	{
+		const std::uint64_t Index = Tail.load(std::memory_order_relaxed);
+		std::uint64_t Free = Capacity - (Index - CachedHead);
+		if (Free < (std::uint64_t)Count)
+		{
+			CachedHead = Head.load(std::memory_order_acquire);
+			Free = Capacity - (Index - CachedHead);
+		}
+
+		const std::int32_t NumPushed = (std::uint64_t)Count < Free ? Count : (std::int32_t)Free;
+		for (std::int32_t Offset = 0; Offset < NumPushed; ++Offset)
+		{
+			new(GetSlot(Index + Offset)) ElementType(Items[Offset]);
+		}
+
+		if (NumPushed > 0)
+		{
+			Tail.store(Index + NumPushed, std::memory_order_release);
+		}
+		return NumPushed;
+	}
+
+	// Consumer methods.
+
+	/**
+	 * Moves the element at the front of the ring into OutItem. Consumer thread only.
+	 *
+	 * @return false if the ring was empty.
+	 */
+	bool TryPop(ElementType& OutItem)
+	{
+		const std::uint64_t Index = Head.load(std::memory_order_relaxed);
+		if (Index == CachedTail)
+		{
+			CachedTail = Tail.load(std::memory_order_acquire);
+			if (Index == CachedTail)
+			{
+				return false;
+			}
+		}
+
+		ElementType* Slot = GetSlot(Index);
+		OutItem = MoveTempIfPossible(*Slot);
+		DestructItem(Slot);
+		Head.store(Index + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Moves up to MaxCount elements from the front of the ring into OutItems, and frees their slots together.
+	 * Consumer thread only.
+	 *
+	 * @return the number of elements popped.
+	 */
+	std::int32_t TryPopN(ElementType* OutItems, std::int32_t MaxCount)
+	{
+		const std::uint64_t Index = Head.load(std::memory_order_relaxed);
+		std::uint64_t Available = CachedTail - Index;
+		if (Available < (std::uint64_t)MaxCount)
+		{
+			CachedTail = Tail.load(std::memory_order_acquire);
+			Available = CachedTail - Index;
+		}
+
+		const std::int32_t NumPopped = (std::uint64_t)MaxCount < Available ? MaxCount : (std::int32_t)Available;
+		for (std::int32_t Offset = 0; Offset < NumPopped; ++Offset)
+		{
+			ElementType* Slot = GetSlot(Index + Offset);
+			OutItems[Offset] = MoveTempIfPossible(*Slot);
+			DestructItem(Slot);
+		}
+
+		if (NumPopped > 0)
+		{
+			Head.store(Index + NumPopped, std::memory_order_release);
+		}
+		return NumPopped;
+	}
+
+	// Accessors. From any thread, these are only a snapshot.
+
+	std::int32_t Num() const
+	{
+		const std::uint64_t Start = Head.load(std::memory_order_acquire);
+		return (std::int32_t)(Tail.load(std::memory_order_acquire) - Start);
+	}
+
+	bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+
+	static constexpr std::int32_t GetCapacity()
+	{
+		return Capacity;
+	}
+
+private:
+	ElementType* GetSlot(std::uint64_t Index)
+	{
+		return (ElementType*)Storage + (Index & IndexMask);
+	}
+
+	/** Written by the producer. */
+	alignas(64) std::atomic<std::uint64_t> Tail;
+	std::uint64_t                          CachedHead;
+
+	/** Written by the consumer. */
+	alignas(64) std::atomic<std::uint64_t> Head;
+	std::uint64_t                          CachedTail;
+
+	alignas(64 > alignof(T) ? 64 : alignof(T)) unsigned char Storage[sizeof(T) * Capacity];
+};
\ No newline at end of file
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "../p2/Util.h"
+#include "../p2/IntrusiveList.h"
+
+/**
+ * The part of a timer the wheel uses: the hook which links it into a slot, and the tick it is due on. Timers derive
+ * from this and add whatever they need to act on expiry; the wheel never allocates or copies them.
+ */
+class FTimerWheelTimer
+{
+public:
+	FTimerWheelTimer()
+		: ExpiryTick(0)
+	{ }
+
+	/**
+	 * A timer must be cancelled, or have fired, before it is destroyed. The wheel counts its timers and tracks which of
+	 * its slots are occupied, and a timer can't reach its wheel to update those.
+	 */
+	~FTimerWheelTimer()
+	{
+		_ASSERT(!IsScheduled());
+	}
+
+	FTimerWheelTimer(const FTimerWheelTimer&) = default;
+	FTimerWheelTimer& operator=(const FTimerWheelTimer&) = default;
+
+	/** @return true while the timer is scheduled on a wheel. */
+	bool IsScheduled() const
+	{
+		return Link.IsLinked();
+	}
+
+	/** @return the tick the timer is (or was last) due on. */
+	std::uint64_t GetExpiryTick() const
+	{
+		return ExpiryTick;
+	}
+
+private:
+	template <typename, std::int32_t> friend class TTimerWheel;
+
+	FIntrusiveListLink Link;
+	std::uint64_t      ExpiryTick;
+};
+
+/**
+ * A hierarchical timer wheel: O(1) Schedule, Cancel and Reschedule for any number of timers.
+ *
+ * Each level is a ring of 64 slots, indexed by one 6-bit digit of the expiry tick, and each slot is an intrusive list
+ * of the timers in it. A timer goes on the lowest level at which its expiry tick still differs from the current tick,
+ * so level 0 holds the timers due within the current 64 ticks, level 1 those due within the current 64 * 64, and so
+ * on; timers further out than the top level wait in an overflow list. When the current tick reaches the start of a
+ * slot's range on a higher level, the slot's timers cascade down to the levels below, until they reach level 0 and
+ * fire on their exact tick.
+ *
+ * Every level keeps a bit mask of its occupied slots, so Advance goes straight to the next tick which has something
+ * to do instead of visiting every tick in between: advancing over an idle stretch is O(NumLevels).
+ *
+ * The wheel doesn't own the timers. A timer has to be cancelled before it is destroyed while scheduled; destroying
+ * the wheel unlinks every timer left on it.
+ */
+template <typename TimerType, std::int32_t NumLevels = 6>
+class TTimerWheel
+{
+	static_assert(std::is_base_of<FTimerWheelTimer, TimerType>::value, "Timers must derive from FTimerWheelTimer");
+	static_assert(NumLevels > 0 && NumLevels * 6 < 64, "NumLevels must be between 1 and 10");
+
+	typedef TIntrusiveDoubleLinkedList<FTimerWheelTimer, &FTimerWheelTimer::Link> FSlotList;
+
+	static constexpr std::int32_t  SlotBits = 6;
+	static constexpr std::int32_t  NumSlots = 1 << SlotBits;
+	static constexpr std::uint64_t SlotMask = NumSlots - 1;
+
+public:
+	/** @param InCurrentTick the tick the wheel starts at. */
+	explicit TTimerWheel(std::uint64_t InCurrentTick = 0)
+		: CurrentTick(InCurrentTick)
+		, NumTimers(0)
+		, OverflowMinTick(UINT64_MAX)
+	{
+		for (std::int32_t Level = 0; Level < NumLevels; ++Level)
+		{
+			OccupiedSlots[Level] = 0;
+		}
+	}
+
+	TTimerWheel(const TTimerWheel&) = delete;
+	TTimerWheel& operator=(const TTimerWheel&) = delete;
+
+	/**
+	 * Schedules Timer to fire DelayTicks from now, at the earliest on the next tick. A timer which is already scheduled
+	 * is moved, so this is also Reschedule.
+	 */
+	void Schedule(TimerType& Timer, std::uint64_t DelayTicks)
+	{
+		ScheduleAt(Timer, CurrentTick + (DelayTicks ? DelayTicks : 1));
+	}
+
+	/** Schedules Timer to fire on InExpiryTick, which must be after the current tick. */
+	void ScheduleAt(TimerType& Timer, std::uint64_t InExpiryTick)
+	{
+		_ASSERT(InExpiryTick > CurrentTick);
+		Cancel(Timer);
+
+		FTimerWheelTimer& Entry = Timer;
+		Entry.ExpiryTick = InExpiryTick;
+		Place(Entry);
+		++NumTimers;
+	}
+
+	/** Same as Schedule; moves a scheduled timer, or schedules one which isn't. */
+	void Reschedule(TimerType& Timer, std::uint64_t DelayTicks)
+	{
+		Schedule(Timer, DelayTicks);
+	}
+
+	/**
+	 * Unschedules Timer, which must be on this wheel if it is scheduled at all.
+	 *
+	 * @return false if the timer wasn't scheduled.
+	 */
+	bool Cancel(TimerType& Timer)
+	{
+		FTimerWheelTimer& Entry = Timer;
+		if (!Entry.IsScheduled())
+		{
+			return false;
+		}
+
+		// The slot a timer is in only depends on its expiry tick and the current tick, see Place.
+		std::int32_t Level;
+		std::uint64_t Slot;
+		FSlotList& List = GetSlotList(Entry.ExpiryTick, Level, Slot);
+		List.RemoveNode(Entry);
+		if (Level < NumLevels && List.IsEmpty())
+		{
+			OccupiedSlots[Level] &= ~(std::uint64_t(1) << Slot);
+		}
+		--NumTimers;
+		return true;
+	}
+
+	/**
+	 * Moves the wheel forward by NumTicks, calling OnExpired(Timer) for every timer which comes due, in order of expiry
+	 * tick. Timers are unscheduled before their callback, which may schedule or cancel any timer, itself included.
+	 *
+	 * @return the number of timers which fired.
+	 */
+	template <typename FuncType>
+	std::int32_t Advance(std::uint64_t NumTicks, FuncType&& OnExpired)
+	{
+		const std::uint64_t TargetTick = CurrentTick + NumTicks;
+		std::int32_t NumFired = 0;
+		for (;;)
+		{
+			const std::uint64_t NextTick = GetNextEventTick();
+			if (NextTick > TargetTick || NextTick <= CurrentTick)
+			{
+				break;
+			}
+
+			CurrentTick = NextTick;
+			Cascade();
+
+			FSlotList& List = Slots[0][CurrentTick & SlotMask];
+			while (FTimerWheelTimer* Entry = List.GetHead())
+			{
+				List.RemoveNode(*Entry);
+				if (List.IsEmpty())
+				{
+					OccupiedSlots[0] &= ~(std::uint64_t(1) << (CurrentTick & SlotMask));
+				}
+				--NumTimers;
+				++NumFired;
+				OnExpired(static_cast<TimerType&>(*Entry));
+			}
+		}
+
+		CurrentTick = TargetTick;
+		return NumFired;
+	}
+
+	/**
+	 * @return the tick of the earliest scheduled timer, or 0 if there are none. A slot above level 0 covers a range of
+	 * ticks and doesn't keep its timers sorted, so this walks every timer in the earliest occupied slot: it is linear in
+	 * the size of that slot, not O(1).
+	 */
+	std::uint64_t GetNextExpiryTick() const
+	{
+		// The lowest occupied level holds the earliest timers.
+		for (std::int32_t Level = 0; Level < NumLevels; ++Level)
+		{
+			for (std::uint64_t Occupied = OccupiedSlots[Level]; Occupied; Occupied &= Occupied - 1)
+			{
+				const FSlotList& List = Slots[Level][CountTrailingZeros64(Occupied)];
+				if (!List.IsEmpty())
+				{
+					return GetEarliestExpiryTick(List);
+				}
+			}
+		}
+		return Overflow.IsEmpty() ? 0 : GetEarliestExpiryTick(Overflow);
+	}
+
+	std::uint64_t GetCurrentTick() const
+	{
+		return CurrentTick;
+	}
+
+	/** @return the number of scheduled timers. */
+	std::int64_t Num() const
+	{
+		return NumTimers;
+	}
+
+	bool IsEmpty() const
+	{
+		return NumTimers == 0;
+	}
+
+private:
+	/** @return the level on which a timer due on InExpiryTick belongs at the current tick; NumLevels for the overflow list. */
+	std::int32_t GetLevel(std::uint64_t InExpiryTick) const
+	{
+		const std::uint64_t Difference = InExpiryTick ^ CurrentTick;
+		if (Difference == 0)
+		{
+			return 0;
+		}
+
+		const std::int32_t Level = (std::int32_t)FloorLog2_64(Difference) / SlotBits;
+		return Level < NumLevels ? Level : NumLevels;
+	}
+
+	FSlotList& GetSlotList(std::uint64_t InExpiryTick, std::int32_t& OutLevel, std::uint64_t& OutSlot)
+	{
+		OutLevel = GetLevel(InExpiryTick);
+		if (OutLevel == NumLevels)
+		{
+			OutSlot = 0;
+			return Overflow;
+		}
+
+		OutSlot = (InExpiryTick >> (OutLevel * SlotBits)) & SlotMask;
+		return Slots[OutLevel][OutSlot];
+	}
+
+	void Place(FTimerWheelTimer& Entry)
+	{
+		std::int32_t Level;
+		std::uint64_t Slot;
+		GetSlotList(Entry.ExpiryTick, Level, Slot).AddTail(Entry);
+		if (Level < NumLevels)
+		{
+			OccupiedSlots[Level] |= std::uint64_t(1) << Slot;
+		}
+		else
+		{
+			OverflowMinTick = Entry.ExpiryTick < OverflowMinTick ? Entry.ExpiryTick : OverflowMinTick;
+		}
+	}
+
+	/**
+	 * @return the next tick after the current one on which a slot has to cascade or fire; earlier than that, nothing
+	 * happens. Returns the current tick if no timers are scheduled.
+	 */
+	std::uint64_t GetNextEventTick() const
+	{
+		// Every timer on level L has the same digits as the current tick above L, and a larger digit at L, so the lowest
+		// occupied level has the next event: the start of its first occupied slot's range.
+		for (std::int32_t Level = 0; Level < NumLevels; ++Level)
+		{
+			if (std::uint64_t Occupied = OccupiedSlots[Level])
+			{
+				const std::int32_t Shift = Level * SlotBits;
+				const std::uint64_t Base = CurrentTick >> (Shift + SlotBits) << (Shift + SlotBits);
+				return Base | ((std::uint64_t)CountTrailingZeros64(Occupied) << Shift);
+			}
+		}
+
+		if (!Overflow.IsEmpty())
+		{
+			// The overflow list is looked at again when the top level comes round to its earliest timer's rotation.
+			const std::int32_t Shift = NumLevels * SlotBits;
+			return OverflowMinTick >> Shift << Shift;
+		}
+		return CurrentTick;
+	}
+
+	/** Moves the timers of every slot whose range starts on the current tick down to where they now belong. */
+	void Cascade()
+	{
+		const std::int32_t TopShift = NumLevels * SlotBits;
+		if ((CurrentTick & ((std::uint64_t(1) << TopShift) - 1)) == 0 && (OverflowMinTick >> TopShift) <= (CurrentTick >> TopShift))
+		{
+			OverflowMinTick = UINT64_MAX;
+			ReplaceAll(Overflow);
+		}
+
+		for (std::int32_t Level = NumLevels - 1; Level > 0; --Level)
+		{
+			const std::int32_t Shift = Level * SlotBits;
+			if ((CurrentTick & ((std::uint64_t(1) << Shift) - 1)) == 0)
+			{
+				const std::uint64_t Slot = (CurrentTick >> Shift) & SlotMask;
+				if (OccupiedSlots[Level] & (std::uint64_t(1) << Slot))
+				{
+					OccupiedSlots[Level] &= ~(std::uint64_t(1) << Slot);
+					ReplaceAll(Slots[Level][Slot]);
+				}
+			}
+		}
+	}
+
+	/** Places every timer in List again. Timers which land back on List are only visited once. */
+	void ReplaceAll(FSlotList& List)
+	{
+		FTimerWheelTimer* Last = List.GetTail();
+		while (Last)
+		{
+			FTimerWheelTimer* Entry = List.GetHead();
+			List.RemoveNode(*Entry);
+			Place(*Entry);
+			if (Entry == Last)
+			{
+				break;
+			}
+		}
+	}
+
+	static std::uint64_t GetEarliestExpiryTick(const FSlotList& List)
+	{
+		std::uint64_t Earliest = UINT64_MAX;
+		for (const FTimerWheelTimer& Entry : List)
+		{
+			Earliest = Entry.ExpiryTick < Earliest ? Entry.ExpiryTick : Earliest;
+		}
+		return Earliest;
+	}
+
+	FSlotList     Slots[NumLevels][NumSlots];
+	FSlotList     Overflow;
+	std::uint64_t OccupiedSlots[NumLevels];
+	std::uint64_t CurrentTick;
+	std::int64_t  NumTimers;
+
+	/** No timer in the overflow list is due before this tick. Cancel doesn't raise it, so it may be early. */
+	std::uint64_t OverflowMinTick;
+};
\ No newline at end of file
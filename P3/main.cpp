@@ -1,5 +1,12 @@
 #include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <memory>
 #include "CircularBuffer.h"
+#include "TimerWheel.h"
+#include "SpscRingBuffer.h"
 
 #define ENABLE_CLASS_PRINT(expr) 
 
@@ -124,9 +131,160 @@ void Test2()
     }
 }
 
+struct FConnectionTimeout : FTimerWheelTimer
+{
+    int ConnectionId = 0;
+};
+
+void TimerWheelTest()
+{
+    // 10M connections with timeouts of up to a minute, in 1ms ticks.
+    const int numConnections = 10000000;
+    std::vector<FConnectionTimeout> timeouts(numConnections);
+    TTimerWheel<FConnectionTimeout> wheel;
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int seed = 1;
+    for (int i = 0; i < numConnections; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        timeouts[i].ConnectionId = i;
+        wheel.Schedule(timeouts[i], 1000 + seed % 59000);
+    }
+    const auto scheduleTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    // Traffic on a connection pushes its timeout back; some connections close cleanly.
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numConnections; i += 2)
+    {
+        wheel.Reschedule(timeouts[i], 30000);
+    }
+    for (int i = 1; i < numConnections; i += 10)
+    {
+        wheel.Cancel(timeouts[i]);
+    }
+    const auto updateTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    long long numExpired = 0;
+    for (int second = 0; second < 60; second++)
+    {
+        numExpired += wheel.Advance(1000, [](FConnectionTimeout&) { });
+    }
+    const auto advanceTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout
+        << "timer wheel: schedule " << scheduleTime.count() << "ms"
+        << " \treschedule/cancel " << updateTime.count() << "ms"
+        << " \tadvance 60s " << advanceTime.count() << "ms"
+        << " \texpired " << numExpired << ", left " << wheel.Num()
+        << std::endl;
+}
+
+template <typename PushFuncType, typename PopFuncType>
+double MeasureItemsPerSecond(long long numItems, PushFuncType&& tryPush, PopFuncType&& tryPop)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::thread producer([&]()
+    {
+        long long next = 0;
+        while (next < numItems)
+        {
+            const int numPushed = tryPush(next, numItems);
+            if (numPushed == 0)
+            {
+                // Full: give the consumer the core, in case the two threads share one.
+                std::this_thread::yield();
+            }
+            next += numPushed;
+        }
+    });
+
+    long long received = 0, sum = 0;
+    while (received < numItems)
+    {
+        const int numPopped = tryPop(sum);
+        if (numPopped == 0)
+        {
+            std::this_thread::yield();
+        }
+        received += numPopped;
+    }
+    producer.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return sum == numItems * (numItems - 1) / 2 ? numItems / seconds : 0.0;
+}
+
+void SpscRingBufferTest()
+{
+    const long long numItems = 20000000;
+
+    std::mutex mutex;
+    CircularBuffer<long long> locked;
+    const double lockedRate = MeasureItemsPerSecond(numItems / 10,
+        [&](long long value, long long) { std::lock_guard<std::mutex> lock(mutex); locked.Push(value); return 1; },
+        [&](long long& sum)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (locked.IsEmpty())
+            {
+                return 0;
+            }
+            sum += locked.Pop();
+            return 1;
+        });
+
+    auto ring = std::make_unique<TSpscRingBuffer<long long, 4096>>();
+    const double singleRate = MeasureItemsPerSecond(numItems,
+        [&](long long value, long long) { return ring->TryPush(value) ? 1 : 0; },
+        [&](long long& sum)
+        {
+            long long value;
+            if (!ring->TryPop(value))
+            {
+                return 0;
+            }
+            sum += value;
+            return 1;
+        });
+
+    const double batchRate = MeasureItemsPerSecond(numItems,
+        [&](long long value, long long end)
+        {
+            long long batch[256];
+            int count = 0;
+            for (; count < 256 && value + count < end; count++)
+            {
+                batch[count] = value + count;
+            }
+            return ring->TryPushN(batch, count);
+        },
+        [&](long long& sum)
+        {
+            long long batch[256];
+            const int count = ring->TryPopN(batch, 256);
+            for (int i = 0; i < count; i++)
+            {
+                sum += batch[i];
+            }
+            return count;
+        });
+
+    std::cout
+        << "mutex + CircularBuffer: " << lockedRate / 1e6 << "M items/s"
+        << " \tSPSC ring: " << singleRate / 1e6 << "M items/s"
+        << " \tSPSC ring batched: " << batchRate / 1e6 << "M items/s"
+        << std::endl;
+}
+
 int main()
 {
     Test();
     std::cout << "--------------\n";
     Test2();
+    std::cout << "--------------\n";
+    TimerWheelTest();
+    std::cout << "--------------\n";
+    SpscRingBufferTest();
 }
\ No newline at end of file
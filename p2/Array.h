@@ -1,6 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <typeinfo>
 #include "Util.h"
+#include "BinaryHeap.h"
 
 #ifndef RESTRICT
 	#define RESTRICT __restrict						/* no alias hint */
@@ -15,13 +17,17 @@ public:
 
 public:
 	TArray()
-		: ArrayNum(0)
+		: ArrayData(nullptr)
+		, ArrayNum(0)
 		, ArrayMax(0)
 	{
 		ResizeTo(DefaultAllocSize);
 	}
 
 	TArray(const TArray& Other)
+		: ArrayData(nullptr)
+		, ArrayNum(0)
+		, ArrayMax(0)
 	{
 		CopyToEmpty(Other.GetData(), Other.Num(), 0);
 	}
@@ -34,6 +40,9 @@ public:
 	}
 
     TArray(TArray&& Other)
+		: ArrayData(nullptr)
+		, ArrayNum(0)
+		, ArrayMax(0)
 	{
 		MoveOrCopy(*this, Other, 0);
 	}
@@ -43,7 +52,10 @@ public:
 		if (this != &Other)
 		{
 			DestructItems(GetData(), ArrayNum);
-			MoveOrCopy(*this, Other, ArrayMax);
+			AllocatorResizeAllocation(0, 0);
+			ArrayNum = 0;
+			ArrayMax = 0;
+			MoveOrCopy(*this, Other, 0);
 		}
 		return *this;
 	}
@@ -51,6 +63,7 @@ public:
     virtual ~TArray()
 	{
 		DestructItems(GetData(), ArrayNum);
+		AllocatorResizeAllocation(0, 0);
 	}
 
 private:
@@ -66,7 +79,7 @@ private:
 			ToArray  .ArrayMax  = FromArray.ArrayMax;
 			FromArray.ArrayData = nullptr;
 			FromArray.ArrayNum  = 0;
-			FromArray.ArrayMax  = DefaultAllocSize;
+			FromArray.ArrayMax  = 0;
 		}
 		else
 		{
@@ -439,6 +452,45 @@ public:
 		RemoveAtImpl(Index, Count, bAllowShrinking);
 	}
 
+	/**
+	 * Removes an element (or elements) at given location, filling the hole with
+	 * the last elements of the array. Does not preserve order, but is O(Count)
+	 * instead of O(Num).
+	 *
+	 * @param Index Location in array of the element to remove.
+	 * @param Count (Optional) Number of elements to remove. Default is 1.
+	 * @param bAllowShrinking (Optional) Tells if this call can shrink array if suitable after remove. Default is true.
+	 */
+	void RemoveAtSwap(SizeType Index, SizeType Count = 1, bool bAllowShrinking = true)
+	{
+		if (Count)
+		{
+			_ASSERT((Count >= 0) & (Index >= 0) & (Index + Count <= ArrayNum));
+
+			DestructItems(GetData() + Index, Count);
+
+			// Replace the elements in the hole created by the removal with elements from the end of the array, so the range of indices used by the array is contiguous.
+			const SizeType NumElementsInHole = Count;
+			const SizeType NumElementsAfterHole = ArrayNum - (Index + Count);
+			const SizeType NumElementsToMoveIntoHole = NumElementsInHole < NumElementsAfterHole ? NumElementsInHole : NumElementsAfterHole;
+			if (NumElementsToMoveIntoHole)
+			{
+				memcpy
+				(
+					(std::uint8_t*)GetData() + (Index) * sizeof(ElementType),
+					(std::uint8_t*)GetData() + (ArrayNum - NumElementsToMoveIntoHole) * sizeof(ElementType),
+					NumElementsToMoveIntoHole * sizeof(ElementType)
+				);
+			}
+			ArrayNum -= Count;
+
+			if (bAllowShrinking)
+			{
+				ResizeShrink();
+			}
+		}
+	}
+
 	void Reset(SizeType NewSize = 0)
 	{
 		// If we have space to hold the excepted size, then don't reallocate
@@ -615,10 +667,187 @@ public:
 		return OriginalNum - ArrayNum;
 	}
 
+	/**
+	 * Sorts the array assuming < operator is defined for the item type.
+	 */
+	void Sort()
+	{
+		Sort(TLess<ElementType>());
+	}
+
+	/**
+	 * Sorts the array using user define predicate class.
+	 *
+	 * @param Predicate Predicate class instance.
+	 */
+	template <class PREDICATE_CLASS>
+	void Sort(const PREDICATE_CLASS& Predicate)
+	{
+		std::sort(GetData(), GetData() + ArrayNum, Predicate);
+	}
+
+	/**
+	 * Stable sorts the array using user defined predicate class. Elements which compare equal keep their relative order.
+	 *
+	 * @param Predicate Predicate class instance
+	 */
+	template <class PREDICATE_CLASS>
+	void StableSort(const PREDICATE_CLASS& Predicate)
+	{
+		std::stable_sort(GetData(), GetData() + ArrayNum, Predicate);
+	}
+
+	void StableSort()
+	{
+		StableSort(TLess<ElementType>());
+	}
+
+	// Heap functions. Arity selects a binary (2) or wider heap; 4 keeps siblings in one cache line.
+
+	/**
+	 * Builds an implicit heap from the array.
+	 *
+	 * @param Predicate Predicate class instance.
+	 */
+	template <int Arity = 2, class PREDICATE_CLASS>
+	void Heapify(const PREDICATE_CLASS& Predicate)
+	{
+		AlgoImpl::HeapifyInternal<Arity>(GetData(), ArrayNum, Predicate);
+	}
+
+	template <int Arity = 2>
+	void Heapify()
+	{
+		Heapify<Arity>(TLess<ElementType>());
+	}
+
+	/**
+	 * Adds a new element to the heap.
+	 *
+	 * @param InItem Item to be added.
+	 * @param Predicate Predicate class instance.
+	 * @return The index of the new element.
+	 */
+	template <int Arity = 2, class PREDICATE_CLASS>
+	SizeType HeapPush(ElementType&& InItem, const PREDICATE_CLASS& Predicate)
+	{
+		Add(MoveTempIfPossible(InItem));
+		return AlgoImpl::HeapSiftUp<Arity>(GetData(), ArrayNum - 1, Predicate);
+	}
+
+	template <int Arity = 2, class PREDICATE_CLASS>
+	SizeType HeapPush(const ElementType& InItem, const PREDICATE_CLASS& Predicate)
+	{
+		Add(InItem);
+		return AlgoImpl::HeapSiftUp<Arity>(GetData(), ArrayNum - 1, Predicate);
+	}
+
+	template <int Arity = 2>
+	SizeType HeapPush(ElementType&& InItem)
+	{
+		return HeapPush<Arity>(MoveTempIfPossible(InItem), TLess<ElementType>());
+	}
+
+	template <int Arity = 2>
+	SizeType HeapPush(const ElementType& InItem)
+	{
+		return HeapPush<Arity>(InItem, TLess<ElementType>());
+	}
+
+	/**
+	 * Removes the top element from the heap.
+	 *
+	 * @param OutItem The removed item.
+	 * @param Predicate Predicate class instance.
+	 * @param bAllowShrinking (Optional) Whether to allow shrinking during remove.
+	 */
+	template <int Arity = 2, class PREDICATE_CLASS>
+	void HeapPop(ElementType& OutItem, const PREDICATE_CLASS& Predicate, bool bAllowShrinking = true)
+	{
+		AlgoImpl::HeapRemoveAtInternal<Arity>(GetData(), SizeType(0), ArrayNum, Predicate);
+		OutItem = MoveTempIfPossible(Last());
+		RemoveAt(ArrayNum - 1, 1, bAllowShrinking);
+	}
+
+	template <int Arity = 2>
+	void HeapPop(ElementType& OutItem, bool bAllowShrinking = true)
+	{
+		HeapPop<Arity>(OutItem, TLess<ElementType>(), bAllowShrinking);
+	}
+
+	/**
+	 * Removes the top element from the heap, discarding it.
+	 *
+	 * @param Predicate Predicate class instance.
+	 * @param bAllowShrinking (Optional) Whether to allow shrinking during remove.
+	 */
+	template <int Arity = 2, class PREDICATE_CLASS>
+	void HeapPopDiscard(const PREDICATE_CLASS& Predicate, bool bAllowShrinking = true)
+	{
+		HeapRemoveAt<Arity>(0, Predicate, bAllowShrinking);
+	}
+
+	template <int Arity = 2>
+	void HeapPopDiscard(bool bAllowShrinking = true)
+	{
+		HeapRemoveAt<Arity>(0, TLess<ElementType>(), bAllowShrinking);
+	}
+
+	/**
+	 * Returns the top element of the heap.
+	 *
+	 * @returns Reference to the top element from the heap.
+	 */
+	const ElementType& HeapTop() const
+	{
+		return GetData()[0];
+	}
+
+	ElementType& HeapTop()
+	{
+		return GetData()[0];
+	}
+
+	/**
+	 * Removes an element from the heap.
+	 *
+	 * @param Index Position at which to remove item.
+	 * @param Predicate Predicate class instance.
+	 * @param bAllowShrinking (Optional) Whether to allow shrinking the array during remove.
+	 */
+	template <int Arity = 2, class PREDICATE_CLASS>
+	void HeapRemoveAt(SizeType Index, const PREDICATE_CLASS& Predicate, bool bAllowShrinking = true)
+	{
+		AlgoImpl::HeapRemoveAtInternal<Arity>(GetData(), Index, ArrayNum, Predicate);
+		RemoveAt(ArrayNum - 1, 1, bAllowShrinking);
+	}
+
+	template <int Arity = 2>
+	void HeapRemoveAt(SizeType Index, bool bAllowShrinking = true)
+	{
+		HeapRemoveAt<Arity>(Index, TLess<ElementType>(), bAllowShrinking);
+	}
+
+	/**
+	 * Performs heap sort on the array.
+	 *
+	 * @param Predicate Predicate class instance.
+	 */
+	template <class PREDICATE_CLASS>
+	void HeapSort(const PREDICATE_CLASS& Predicate)
+	{
+		AlgoImpl::HeapSortInternal<2>(GetData(), ArrayNum, Predicate);
+	}
+
+	void HeapSort()
+	{
+		HeapSort(TLess<ElementType>());
+	}
+
 private:
 	void AllocatorResizeAllocation(SizeType CurrentArrayNum, SizeType NewArrayMax)
 	{
-		ResizeAllocation(ArrayData, CurrentArrayNum, NewArrayMax, sizeof(ElementType));
+		ResizeAllocation(ArrayData, CurrentArrayNum, NewArrayMax, sizeof(ElementType), &GetMemoryTypeTag<TArray>());
 	}
 
 	SizeType AllocatorCalculateSlackShrink(SizeType CurrentArrayNum, SizeType NewArrayMax)
@@ -701,10 +930,20 @@ private:
 		}
 		else
 		{
-			ArrayMax = DefaultAllocSize;
+			ArrayMax = PrevMax;
 		}
 	}
 
+protected:
+	/**
+	 * DO NOT USE DIRECTLY
+	 * STL-like iterators to enable range-based for loop support.
+	 */
+	friend       ElementType* begin(      TArray& Array) { return Array.GetData(); }
+	friend const ElementType* begin(const TArray& Array) { return Array.GetData(); }
+	friend       ElementType* end  (      TArray& Array) { return Array.GetData() + Array.Num(); }
+	friend const ElementType* end  (const TArray& Array) { return Array.GetData() + Array.Num(); }
+
 protected:
 	void*                ArrayData;
 	SizeType             ArrayNum;
@@ -0,0 +1,475 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include "ArrayView.h"
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+	#include <sys/types.h>
+	#include <sys/stat.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+/**
+ * Binary snapshot format for TArray:
+ *
+ *		FArrayFileHeader (64 bytes)
+ *		element data
+ *
+ * For trivially copyable element types the data is the raw array memory, written with one
+ * writev and loadable either with one read or, without any copy, through TMappedArrayView.
+ * The header is padded to 64 bytes so the mapped elements are cache-line aligned.
+ *
+ * Other element types are streamed one at a time through a TArraySerializer specialization.
+ */
+struct FArrayFileHeader
+{
+	static constexpr std::uint32_t MagicValue     = 0x52524154; // "TARR"
+	static constexpr std::uint16_t CurrentVersion = 2;
+
+	/** Stored in the writer's byte order; reads back differently on a machine of the other endianness. */
+	static constexpr std::uint32_t ByteOrderValue = 0x01020304;
+
+	enum EFlags : std::uint16_t
+	{
+		Flag_RawElements = 1 << 0,
+	};
+
+	std::uint32_t Magic;
+	std::uint16_t Version;
+	std::uint16_t Flags;
+	std::uint32_t ElementSize;
+	std::uint32_t ElementAlignment;
+	std::uint64_t Num;
+	std::uint32_t ByteOrder;
+	std::uint8_t  Padding[36];
+
+	template <typename ElementType>
+	static FArrayFileHeader Make(std::uint64_t InNum, bool bRawElements)
+	{
+		FArrayFileHeader Header;
+		memset(&Header, 0, sizeof(Header));
+		Header.Magic = MagicValue;
+		Header.Version = CurrentVersion;
+		Header.Flags = bRawElements ? Flag_RawElements : 0;
+		Header.ElementSize = sizeof(ElementType);
+		Header.ElementAlignment = alignof(ElementType);
+		Header.Num = InNum;
+		Header.ByteOrder = ByteOrderValue;
+		return Header;
+	}
+
+	/** @return true if the header describes an array of ElementType which this code can read. */
+	template <typename ElementType>
+	bool IsValidFor(bool bRawElements) const
+	{
+		return Magic == MagicValue
+			&& Version == CurrentVersion
+			&& ByteOrder == ByteOrderValue
+			&& ((Flags & Flag_RawElements) != 0) == bRawElements
+			&& ElementSize == sizeof(ElementType)
+			&& ElementAlignment == alignof(ElementType)
+			&& Num <= std::uint64_t(INT32_MAX);
+	}
+};
+static_assert(sizeof(FArrayFileHeader) == 64, "FArrayFileHeader must stay 64 bytes so mapped data is aligned");
+
+/** Sequential binary output used by streaming serializers. */
+class FArrayWriter
+{
+public:
+	explicit FArrayWriter(std::FILE* InFile)
+		: File(InFile)
+	{ }
+
+	bool Serialize(const void* Data, std::size_t Num)
+	{
+		return std::fwrite(Data, 1, Num, File) == Num;
+	}
+
+	template <typename T>
+	bool operator<<(const T& Value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written directly");
+		return Serialize(&Value, sizeof(T));
+	}
+
+private:
+	std::FILE* File;
+};
+
+/** Sequential binary input used by streaming serializers. */
+class FArrayReader
+{
+public:
+	explicit FArrayReader(std::FILE* InFile)
+		: File(InFile)
+	{ }
+
+	bool Serialize(void* Data, std::size_t Num)
+	{
+		return std::fread(Data, 1, Num, File) == Num;
+	}
+
+	template <typename T>
+	bool operator>>(T& Value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read directly");
+		return Serialize(&Value, sizeof(T));
+	}
+
+private:
+	std::FILE* File;
+};
+
+/**
+ * Streaming serializer hook for element types which are not trivially copyable.
+ * Specialize this for your type:
+ *
+ *		template <> struct TArraySerializer<FMyType>
+ *		{
+ *			static bool Save(FArrayWriter& Writer, const FMyType& Value);
+ *			static bool Load(FArrayReader& Reader, FMyType& Value);
+ *		};
+ */
+template <typename ElementType>
+struct TArraySerializer;
+
+template <typename ElementType, typename = void>
+struct THasArraySerializer : std::false_type
+{ };
+
+template <typename ElementType>
+struct THasArraySerializer<ElementType, std::void_t<decltype(sizeof(TArraySerializer<ElementType>))>> : std::true_type
+{ };
+
+template <typename ElementType>
+constexpr bool TCanSerializeArrayRaw()
+{
+	return std::is_trivially_copyable_v<ElementType>;
+}
+
+namespace ArraySerializationImpl
+{
+	/** @return the number of bytes in File after the current position, or 0 if that can't be determined. */
+	inline std::uint64_t GetRemainingSize(std::FILE* File)
+	{
+		const long Position = std::ftell(File);
+#if defined(_WIN32)
+		struct _stat64 FileStat;
+		if (Position < 0 || ::_fstat64(::_fileno(File), &FileStat) != 0 || FileStat.st_size < Position)
+#else
+		struct stat FileStat;
+		if (Position < 0 || ::fstat(::fileno(File), &FileStat) != 0 || FileStat.st_size < Position)
+#endif
+		{
+			return 0;
+		}
+		return std::uint64_t(FileStat.st_size) - std::uint64_t(Position);
+	}
+
+	inline bool WriteAll(const char* Filename, const void* Header, std::size_t HeaderSize, const void* Data, std::size_t DataSize)
+	{
+#if defined(_WIN32)
+		std::FILE* File = std::fopen(Filename, "wb");
+		if (!File)
+		{
+			return false;
+		}
+		bool bOk = std::fwrite(Header, 1, HeaderSize, File) == HeaderSize;
+		bOk = bOk && (!DataSize || std::fwrite(Data, 1, DataSize, File) == DataSize);
+		return (std::fclose(File) == 0) && bOk;
+#else
+		const int FileHandle = ::open(Filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (FileHandle < 0)
+		{
+			return false;
+		}
+
+		// Header and data go out in one gathered write; loop only for partial writes.
+		iovec Buffers[2] = { { const_cast<void*>(Header), HeaderSize }, { const_cast<void*>(Data), DataSize } };
+		iovec* Remaining = Buffers;
+		int NumRemaining = DataSize ? 2 : 1;
+		bool bOk = true;
+		while (NumRemaining)
+		{
+			const ssize_t Written = ::writev(FileHandle, Remaining, NumRemaining);
+			if (Written < 0)
+			{
+				bOk = false;
+				break;
+			}
+
+			std::size_t Consumed = (std::size_t)Written;
+			while (NumRemaining && Consumed >= Remaining->iov_len)
+			{
+				Consumed -= Remaining->iov_len;
+				++Remaining;
+				--NumRemaining;
+			}
+			if (NumRemaining)
+			{
+				Remaining->iov_base = (std::uint8_t*)Remaining->iov_base + Consumed;
+				Remaining->iov_len -= Consumed;
+			}
+		}
+		return (::close(FileHandle) == 0) && bOk;
+#endif
+	}
+}
+
+/**
+ * Writes an array to a file.
+ *
+ * @return true if the whole array was written.
+ */
+template <typename ElementType>
+bool SaveArray(const TArray<ElementType>& Array, const char* Filename)
+{
+	if constexpr (TCanSerializeArrayRaw<ElementType>())
+	{
+		const FArrayFileHeader Header = FArrayFileHeader::Make<ElementType>(Array.Num(), true);
+		return ArraySerializationImpl::WriteAll(Filename, &Header, sizeof(Header), Array.GetData(), std::size_t(Array.Num()) * sizeof(ElementType));
+	}
+	else
+	{
+		static_assert(THasArraySerializer<ElementType>::value, "Element type is not trivially copyable; specialize TArraySerializer for it");
+
+		std::FILE* File = std::fopen(Filename, "wb");
+		if (!File)
+		{
+			return false;
+		}
+
+		const FArrayFileHeader Header = FArrayFileHeader::Make<ElementType>(Array.Num(), false);
+		FArrayWriter Writer(File);
+		bool bOk = Writer.Serialize(&Header, sizeof(Header));
+		for (const ElementType& Element : Array)
+		{
+			if (!bOk)
+			{
+				break;
+			}
+			bOk = TArraySerializer<ElementType>::Save(Writer, Element);
+		}
+		return (std::fclose(File) == 0) && bOk;
+	}
+}
+
+/**
+ * Reads an array written by SaveArray, replacing the contents of Array.
+ *
+ * @return false if the file could not be read or doesn't hold an array of ElementType; Array is left empty.
+ */
+template <typename ElementType>
+bool LoadArray(TArray<ElementType>& Array, const char* Filename)
+{
+	constexpr bool bRawElements = TCanSerializeArrayRaw<ElementType>();
+	if constexpr (!bRawElements)
+	{
+		static_assert(THasArraySerializer<ElementType>::value, "Element type is not trivially copyable; specialize TArraySerializer for it");
+	}
+
+	Array.Reset();
+
+	std::FILE* File = std::fopen(Filename, "rb");
+	if (!File)
+	{
+		return false;
+	}
+
+	FArrayReader Reader(File);
+	FArrayFileHeader Header;
+	bool bOk = Reader.Serialize(&Header, sizeof(Header)) && Header.IsValidFor<ElementType>(bRawElements);
+	if (bOk)
+	{
+		// Check the count against the file before allocating for it, so a corrupt or truncated file can't make us
+		// reserve gigabytes. Streamed elements take at least a byte each, as far as the reservation is concerned.
+		const std::uint64_t RemainingSize = ArraySerializationImpl::GetRemainingSize(File);
+		if constexpr (bRawElements)
+		{
+			bOk = Header.Num * sizeof(ElementType) <= RemainingSize;
+		}
+		else
+		{
+			Array.Reserve((std::int32_t)(Header.Num < RemainingSize ? Header.Num : RemainingSize));
+		}
+	}
+	if (bOk)
+	{
+		const std::int32_t Num = (std::int32_t)Header.Num;
+		if constexpr (bRawElements)
+		{
+			Array.AddUninitialized(Num);
+			bOk = Reader.Serialize(Array.GetData(), std::size_t(Num) * sizeof(ElementType));
+		}
+		else
+		{
+			for (std::int32_t Index = 0; bOk && Index < Num; ++Index)
+			{
+				bOk = TArraySerializer<ElementType>::Load(Reader, Array[Array.Emplace()]);
+			}
+		}
+	}
+
+	std::fclose(File);
+	if (!bOk)
+	{
+		Array.Reset();
+	}
+	return bOk;
+}
+
+/**
+ * A read-only view of an array file written by SaveArray, mapped into memory instead of read.
+ * Opening is O(1) regardless of the file size; pages are faulted in on first access and shared
+ * with the page cache. The view stays valid for the lifetime of this object.
+ */
+template <typename InElementType>
+class TMappedArrayView
+{
+	static_assert(TCanSerializeArrayRaw<InElementType>(), "Only trivially copyable arrays can be mapped");
+
+public:
+	typedef InElementType ElementType;
+
+	TMappedArrayView()
+		: MappedData(nullptr)
+		, MappedSize(0)
+#if defined(_WIN32)
+		, FileHandle(INVALID_HANDLE_VALUE)
+		, MappingHandle(nullptr)
+#endif
+	{ }
+
+	~TMappedArrayView()
+	{
+		Close();
+	}
+
+	TMappedArrayView(const TMappedArrayView&) = delete;
+	TMappedArrayView& operator=(const TMappedArrayView&) = delete;
+
+	/**
+	 * Maps the given file.
+	 *
+	 * @return false if the file could not be mapped or doesn't hold an array of ElementType.
+	 */
+	bool Open(const char* Filename)
+	{
+		Close();
+
+#if defined(_WIN32)
+		FileHandle = ::CreateFileA(Filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (FileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER FileSize;
+		if (!::GetFileSizeEx(FileHandle, &FileSize) || std::uint64_t(FileSize.QuadPart) < sizeof(FArrayFileHeader))
+		{
+			Close();
+			return false;
+		}
+
+		MappingHandle = ::CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		MappedData = MappingHandle ? ::MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		MappedSize = std::size_t(FileSize.QuadPart);
+#else
+		const int FileHandle = ::open(Filename, O_RDONLY);
+		if (FileHandle < 0)
+		{
+			return false;
+		}
+
+		struct stat FileStat;
+		if (::fstat(FileHandle, &FileStat) != 0 || std::uint64_t(FileStat.st_size) < sizeof(FArrayFileHeader))
+		{
+			::close(FileHandle);
+			return false;
+		}
+
+		MappedSize = std::size_t(FileStat.st_size);
+		void* Mapping = ::mmap(nullptr, MappedSize, PROT_READ, MAP_SHARED, FileHandle, 0);
+		MappedData = Mapping != MAP_FAILED ? Mapping : nullptr;
+
+		// The mapping keeps its own reference to the file.
+		::close(FileHandle);
+#endif
+
+		if (!MappedData || !IsValid())
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+#if defined(_WIN32)
+		if (MappedData)
+		{
+			::UnmapViewOfFile(MappedData);
+		}
+		if (MappingHandle)
+		{
+			::CloseHandle(MappingHandle);
+			MappingHandle = nullptr;
+		}
+		if (FileHandle != INVALID_HANDLE_VALUE)
+		{
+			::CloseHandle(FileHandle);
+			FileHandle = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (MappedData)
+		{
+			::munmap(MappedData, MappedSize);
+		}
+#endif
+		MappedData = nullptr;
+		MappedSize = 0;
+	}
+
+	bool IsOpen() const
+	{
+		return MappedData != nullptr;
+	}
+
+	/** @return a view of the mapped elements; empty if nothing is mapped. */
+	TArrayView<const ElementType> GetView() const
+	{
+		if (!MappedData)
+		{
+			return TArrayView<const ElementType>();
+		}
+
+		const FArrayFileHeader* Header = (const FArrayFileHeader*)MappedData;
+		return TArrayView<const ElementType>((const ElementType*)(Header + 1), (std::int32_t)Header->Num);
+	}
+
+private:
+	bool IsValid() const
+	{
+		const FArrayFileHeader* Header = (const FArrayFileHeader*)MappedData;
+		return Header->IsValidFor<ElementType>(true)
+			&& sizeof(FArrayFileHeader) + Header->Num * sizeof(ElementType) <= MappedSize;
+	}
+
+	void*       MappedData;
+	std::size_t MappedSize;
+#if defined(_WIN32)
+	HANDLE      FileHandle;
+	HANDLE      MappingHandle;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include "Array.h"
+
+/**
+ * Templated fixed-size view of another array
+ *
+ * A statically sized view of an array of typed elements.  Designed to allow functions to take either a fixed C array
+ * or a TArray with an arbitrary allocator as an argument when the function neither adds nor removes elements
+ *
+ * A TArrayView does not own the memory it points to; the viewed storage must outlive the view.
+ */
+template <typename InElementType, typename SizeType = std::int32_t>
+class TArrayView
+{
+public:
+	typedef InElementType ElementType;
+
+	TArrayView()
+		: DataPtr(nullptr)
+		, ArrayNum(0)
+	{ }
+
+	TArrayView(ElementType* InData, SizeType InCount)
+		: DataPtr(InData)
+		, ArrayNum(InCount)
+	{
+		_ASSERT(ArrayNum >= 0);
+	}
+
+	/** Constructs a view of a TArray; a view of const elements can be made from a const array. */
+	template <typename OtherElementType, typename = std::enable_if_t<std::is_convertible_v<OtherElementType*, ElementType*>>>
+	TArrayView(TArray<OtherElementType>& Other)
+		: DataPtr(Other.GetData())
+		, ArrayNum(Other.Num())
+	{ }
+
+	template <typename OtherElementType, typename = std::enable_if_t<std::is_convertible_v<const OtherElementType*, ElementType*>>>
+	TArrayView(const TArray<OtherElementType>& Other)
+		: DataPtr(Other.GetData())
+		, ArrayNum(Other.Num())
+	{ }
+
+	ElementType* GetData() const
+	{
+		return DataPtr;
+	}
+
+	static constexpr std::size_t GetTypeSize()
+	{
+		return sizeof(ElementType);
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return (Index >= 0) && (Index < ArrayNum);
+	}
+
+	bool IsEmpty() const
+	{
+		return ArrayNum == 0;
+	}
+
+	SizeType Num() const
+	{
+		return ArrayNum;
+	}
+
+	ElementType& operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return DataPtr[Index];
+	}
+
+	ElementType& Last(SizeType IndexFromTheEnd = 0) const
+	{
+		return DataPtr[ArrayNum - IndexFromTheEnd - 1];
+	}
+
+	/** @return a view of Count elements starting at Index. */
+	TArrayView Slice(SizeType Index, SizeType Count) const
+	{
+		_ASSERT(Index >= 0 && Count >= 0 && Index + Count <= ArrayNum);
+		return TArrayView(DataPtr + Index, Count);
+	}
+
+private:
+	ElementType* DataPtr;
+	SizeType     ArrayNum;
+
+	friend ElementType* begin(const TArrayView& View) { return View.GetData(); }
+	friend ElementType* end  (const TArrayView& View) { return View.GetData() + View.Num(); }
+};
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+#include <utility>
+
+/**
+ * Heap primitives shared by TArray's Heap* functions and TPriorityQueue.
+ *
+ * The heaps are d-ary: Arity 2 is the classic binary heap, while Arity 4 halves the
+ * depth and puts all the children of a node in one cache line for small elements,
+ * which usually wins once the heap no longer fits in L1.
+ *
+ * The element at index 0 is the one for which Predicate(Element, Other) is true for every
+ * other element, so TLess gives a min-heap. Sifting moves a hole instead of swapping, and
+ * OnMoved(Element, NewIndex) is called for every element placed, which lets callers track
+ * where their elements live in the heap.
+ */
+namespace AlgoImpl
+{
+	/** Callback for heaps which don't track element positions. */
+	struct FHeapNoIndexTracking
+	{
+		template <typename ElementType, typename IndexType>
+		constexpr void operator()(const ElementType&, IndexType) const
+		{ }
+	};
+
+	template <int Arity, typename IndexType>
+	constexpr IndexType HeapGetParentIndex(IndexType Index)
+	{
+		return (Index - 1) / Arity;
+	}
+
+	template <int Arity, typename IndexType>
+	constexpr IndexType HeapGetFirstChildIndex(IndexType Index)
+	{
+		return Index * Arity + 1;
+	}
+
+	/**
+	 * Fixes a possible violation of order property between node at Index and its children.
+	 *
+	 * @param	Heap		Pointer to the first element of a heap.
+	 * @param	Index		Node index.
+	 * @param	Count		Size of the heap.
+	 * @param	Predicate	A binary predicate object used to specify if one element should precede another.
+	 * @param	OnMoved		Called with every element which is placed, and its new index.
+	 * @return	The new index of the node that was at Index.
+	 */
+	template <int Arity, typename RangeValueType, typename IndexType, typename PredicateType, typename OnMovedType = FHeapNoIndexTracking>
+	constexpr IndexType HeapSiftDown(RangeValueType* Heap, IndexType Index, const IndexType Count, const PredicateType& Predicate, const OnMovedType& OnMoved = OnMovedType())
+	{
+		static_assert(Arity >= 2, "A heap needs at least two children per node");
+
+		RangeValueType Value = std::move(Heap[Index]);
+		for (;;)
+		{
+			const IndexType FirstChildIndex = HeapGetFirstChildIndex<Arity>(Index);
+			if (FirstChildIndex >= Count)
+			{
+				break;
+			}
+
+			const IndexType EndChildIndex = Count - FirstChildIndex > Arity ? FirstChildIndex + Arity : Count;
+			IndexType BestChildIndex = FirstChildIndex;
+			for (IndexType ChildIndex = FirstChildIndex + 1; ChildIndex < EndChildIndex; ++ChildIndex)
+			{
+				BestChildIndex = Predicate(Heap[ChildIndex], Heap[BestChildIndex]) ? ChildIndex : BestChildIndex;
+			}
+
+			if (!Predicate(Heap[BestChildIndex], Value))
+			{
+				break;
+			}
+
+			Heap[Index] = std::move(Heap[BestChildIndex]);
+			OnMoved(Heap[Index], Index);
+			Index = BestChildIndex;
+		}
+
+		Heap[Index] = std::move(Value);
+		OnMoved(Heap[Index], Index);
+		return Index;
+	}
+
+	/**
+	 * Fixes a possible violation of order property between node at NodeIndex and its parents.
+	 *
+	 * @param	Heap		Pointer to the first element of a heap.
+	 * @param	NodeIndex	Node index.
+	 * @param	Predicate	A binary predicate object used to specify if one element should precede another.
+	 * @param	OnMoved		Called with every element which is placed, and its new index.
+	 * @return	The new index of the node that was at NodeIndex.
+	 */
+	template <int Arity, typename RangeValueType, typename IndexType, typename PredicateType, typename OnMovedType = FHeapNoIndexTracking>
+	constexpr IndexType HeapSiftUp(RangeValueType* Heap, IndexType NodeIndex, const PredicateType& Predicate, const OnMovedType& OnMoved = OnMovedType())
+	{
+		RangeValueType Value = std::move(Heap[NodeIndex]);
+		while (NodeIndex > 0)
+		{
+			const IndexType ParentIndex = HeapGetParentIndex<Arity>(NodeIndex);
+			if (!Predicate(Value, Heap[ParentIndex]))
+			{
+				break;
+			}
+
+			Heap[NodeIndex] = std::move(Heap[ParentIndex]);
+			OnMoved(Heap[NodeIndex], NodeIndex);
+			NodeIndex = ParentIndex;
+		}
+
+		Heap[NodeIndex] = std::move(Value);
+		OnMoved(Heap[NodeIndex], NodeIndex);
+		return NodeIndex;
+	}
+
+	/**
+	 * Builds an implicit min-heap from a range of elements, bottom-up in O(Num).
+	 *
+	 * @param	First		Pointer to the first element to heapify.
+	 * @param	Num			The number of items to heapify.
+	 * @param	Predicate	A binary predicate object used to specify if one element should precede another.
+	 */
+	template <int Arity, typename RangeValueType, typename IndexType, typename PredicateType, typename OnMovedType = FHeapNoIndexTracking>
+	constexpr void HeapifyInternal(RangeValueType* First, IndexType Num, const PredicateType& Predicate, const OnMovedType& OnMoved = OnMovedType())
+	{
+		if (Num < 2)
+		{
+			for (IndexType Index = 0; Index < Num; ++Index)
+			{
+				OnMoved(First[Index], Index);
+			}
+			return;
+		}
+
+		for (IndexType Index = Num - 1; Index > HeapGetParentIndex<Arity>(Num - 1); --Index)
+		{
+			OnMoved(First[Index], Index);
+		}
+		for (IndexType Index = HeapGetParentIndex<Arity>(Num - 1); Index >= 0; --Index)
+		{
+			HeapSiftDown<Arity>(First, Index, Num, Predicate, OnMoved);
+		}
+	}
+
+	/**
+	 * Removes the element at Index from a heap of Count elements, keeping the heap property.
+	 * The removed element is left at the end of the range (index Count - 1) for the caller to pop.
+	 */
+	template <int Arity, typename RangeValueType, typename IndexType, typename PredicateType, typename OnMovedType = FHeapNoIndexTracking>
+	constexpr void HeapRemoveAtInternal(RangeValueType* Heap, IndexType Index, IndexType Count, const PredicateType& Predicate, const OnMovedType& OnMoved = OnMovedType())
+	{
+		const IndexType LastIndex = Count - 1;
+		if (Index == LastIndex)
+		{
+			return;
+		}
+
+		RangeValueType Removed = std::move(Heap[Index]);
+		Heap[Index] = std::move(Heap[LastIndex]);
+		Heap[LastIndex] = std::move(Removed);
+
+		// The replacement may need to go either way.
+		const IndexType NewIndex = HeapSiftDown<Arity>(Heap, Index, LastIndex, Predicate, OnMoved);
+		HeapSiftUp<Arity>(Heap, NewIndex, Predicate, OnMoved);
+	}
+
+	/**
+	 * Performs heap sort on the elements, in place. The result is ordered by Predicate.
+	 */
+	template <int Arity, typename RangeValueType, typename IndexType, typename PredicateType>
+	constexpr void HeapSortInternal(RangeValueType* First, IndexType Num, const PredicateType& Predicate)
+	{
+		// Build a heap with the "largest" element on top, then repeatedly move the top to the end.
+		const auto ReversePredicate = [&Predicate](const RangeValueType& A, const RangeValueType& B) { return Predicate(B, A); };
+		HeapifyInternal<Arity>(First, Num, ReversePredicate);
+		for (IndexType Index = Num - 1; Index > 0; --Index)
+		{
+			RangeValueType Top = std::move(First[0]);
+			First[0] = std::move(First[Index]);
+			First[Index] = std::move(Top);
+			HeapSiftDown<Arity>(First, IndexType(0), Index, ReversePredicate);
+		}
+	}
+}
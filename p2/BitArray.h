@@ -0,0 +1,519 @@
+#pragma once
+#include "Array.h"
+
+#if defined(__AVX2__)
+	#define BITARRAY_USE_AVX2 1
+	#define BITARRAY_USE_SSE2 0
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BITARRAY_USE_AVX2 0
+	#define BITARRAY_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define BITARRAY_USE_AVX2 0
+	#define BITARRAY_USE_SSE2 0
+#endif
+
+/** Used to reference a bit in an unspecified bit array. */
+class FBitReference
+{
+public:
+	FBitReference(std::uint64_t& InData, std::uint64_t InMask)
+		: Data(InData)
+		, Mask(InMask)
+	{ }
+
+	operator bool() const
+	{
+		return (Data & Mask) != 0;
+	}
+
+	void operator=(const bool NewValue)
+	{
+		if (NewValue)
+		{
+			Data |= Mask;
+		}
+		else
+		{
+			Data &= ~Mask;
+		}
+	}
+
+	FBitReference& operator=(const FBitReference& Copy)
+	{
+		// As this is emulating a reference, assignment should not rebind,
+		// it should write to the referenced bit.
+		*this = (bool)Copy;
+		return *this;
+	}
+
+private:
+	std::uint64_t& Data;
+	std::uint64_t  Mask;
+};
+
+/** The word-wise operation applied by TBitArray's bitwise combine functions. */
+enum class EBitwiseOperator
+{
+	And,
+	Or,
+	Xor,
+};
+
+/**
+ * A dynamically sized bit array, storing one bit per element in 64-bit words.
+ * Bits past Num() in the last word are always kept clear, so whole words can be scanned without masking.
+ */
+class TBitArray
+{
+public:
+	typedef std::int32_t SizeType;
+
+	static constexpr SizeType NumBitsPerWord = 64;
+
+	inline const static SizeType INDEX_NONE = -1;
+
+	TBitArray()
+		: NumBits(0)
+	{ }
+
+	/**
+	 * Constructs a bit array with the given number of bits.
+	 *
+	 * @param bValue The value to initialize the bits to.
+	 * @param InNumBits The initial number of bits in the array.
+	 */
+	TBitArray(bool bValue, SizeType InNumBits)
+		: NumBits(0)
+	{
+		Init(bValue, InNumBits);
+	}
+
+	/**
+	 * Resets the array's contents to the given number of bits.
+	 *
+	 * @param bValue The value to initialize the bits to.
+	 * @param InNumBits The number of bits in the array.
+	 */
+	void Init(bool bValue, SizeType InNumBits)
+	{
+		Words.Reset();
+		NumBits = 0;
+		SetNum(InNumBits, bValue);
+	}
+
+	/**
+	 * Resizes the array, initializing any newly added bits.
+	 *
+	 * @param InNumBits The new number of bits in the array.
+	 * @param bValue The value to initialize new bits to.
+	 */
+	void SetNum(SizeType InNumBits, bool bValue)
+	{
+		_ASSERT(InNumBits >= 0);
+		const SizeType OldNumBits = NumBits;
+		const SizeType NewNumWords = CalculateNumWords(InNumBits);
+		if (NewNumWords > Words.Num())
+		{
+			const SizeType Index = Words.AddUninitialized(NewNumWords - Words.Num());
+			memset(Words.GetData() + Index, bValue ? 0xFF : 0, (NewNumWords - Index) * sizeof(std::uint64_t));
+		}
+		else if (NewNumWords < Words.Num())
+		{
+			Words.RemoveAt(NewNumWords, Words.Num() - NewNumWords, false);
+		}
+		NumBits = InNumBits;
+
+		if (InNumBits > OldNumBits && (OldNumBits % NumBitsPerWord))
+		{
+			// Fill the tail of the previous last word.
+			const std::uint64_t TailMask = ~std::uint64_t(0) << (OldNumBits % NumBitsPerWord);
+			std::uint64_t& Word = Words[OldNumBits / NumBitsPerWord];
+			Word = bValue ? (Word | TailMask) : (Word & ~TailMask);
+		}
+		ClearPartialSlackBits();
+	}
+
+	/**
+	 * Adds a bit to the array with the given value.
+	 *
+	 * @return The index of the added bit.
+	 */
+	SizeType Add(const bool bValue)
+	{
+		const SizeType Index = NumBits;
+		if (Index % NumBitsPerWord == 0)
+		{
+			Words.Add(0);
+		}
+		++NumBits;
+		if (bValue)
+		{
+			Words[Index / NumBitsPerWord] |= GetBitMask(Index);
+		}
+		return Index;
+	}
+
+	/**
+	 * Removes all bits from the array, potentially leaving space allocated for an expected number of bits about to be added.
+	 *
+	 * @param ExpectedNumBits The expected number of bits about to be added.
+	 */
+	void Empty(SizeType ExpectedNumBits = 0)
+	{
+		Words.Empty(CalculateNumWords(ExpectedNumBits));
+		NumBits = 0;
+	}
+
+	/** Removes all bits from the array retaining any space already allocated. */
+	void Reset()
+	{
+		Words.Reset();
+		NumBits = 0;
+	}
+
+	/** Reserves memory such that the array can contain at least Number bits. */
+	void Reserve(SizeType Number)
+	{
+		Words.Reserve(CalculateNumWords(Number));
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < NumBits;
+	}
+
+	SizeType Num() const
+	{
+		return NumBits;
+	}
+
+	FBitReference operator[](SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		return FBitReference(Words[Index / NumBitsPerWord], GetBitMask(Index));
+	}
+
+	bool operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return (Words[Index / NumBitsPerWord] & GetBitMask(Index)) != 0;
+	}
+
+	/** @return the words backing the array; bits past Num() are zero. */
+	std::uint64_t* GetData()
+	{
+		return Words.GetData();
+	}
+
+	const std::uint64_t* GetData() const
+	{
+		return Words.GetData();
+	}
+
+	SizeType NumWords() const
+	{
+		return Words.Num();
+	}
+
+	static SizeType CalculateNumWords(SizeType InNumBits)
+	{
+		return (InNumBits + NumBitsPerWord - 1) / NumBitsPerWord;
+	}
+
+	// Word-parallel operations.
+	// When the arrays differ in size, the shorter one behaves as if it were padded with zeros.
+
+	/** this = this & Other. The size of this array is maintained. */
+	void CombineWithBitwiseAND(const TBitArray& Other)
+	{
+		const SizeType NumCommonWords = Other.NumWords() < NumWords() ? Other.NumWords() : NumWords();
+		CombineWords<EBitwiseOperator::And>(GetData(), Other.GetData(), NumCommonWords);
+		if (NumCommonWords < NumWords())
+		{
+			memset(GetData() + NumCommonWords, 0, (NumWords() - NumCommonWords) * sizeof(std::uint64_t));
+		}
+	}
+
+	/** this = this | Other. This array grows to the size of Other if it is shorter. */
+	void CombineWithBitwiseOR(const TBitArray& Other)
+	{
+		if (Other.Num() > Num())
+		{
+			SetNum(Other.Num(), false);
+		}
+		CombineWords<EBitwiseOperator::Or>(GetData(), Other.GetData(), Other.NumWords());
+	}
+
+	/** this = this ^ Other. This array grows to the size of Other if it is shorter. */
+	void CombineWithBitwiseXOR(const TBitArray& Other)
+	{
+		if (Other.Num() > Num())
+		{
+			SetNum(Other.Num(), false);
+		}
+		CombineWords<EBitwiseOperator::Xor>(GetData(), Other.GetData(), Other.NumWords());
+	}
+
+	/** Flips every bit in the array. */
+	void BitwiseNOT()
+	{
+		std::uint64_t* RESTRICT Data = GetData();
+		const SizeType Count = NumWords();
+		SizeType Index = 0;
+#if BITARRAY_USE_AVX2
+		const __m256i AllOnes = _mm256_set1_epi64x(-1);
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			__m256i* Ptr = (__m256i*)(Data + Index);
+			_mm256_storeu_si256(Ptr, _mm256_xor_si256(_mm256_loadu_si256(Ptr), AllOnes));
+		}
+#elif BITARRAY_USE_SSE2
+		const __m128i AllOnes = _mm_set1_epi32(-1);
+		for (; Index + 2 <= Count; Index += 2)
+		{
+			__m128i* Ptr = (__m128i*)(Data + Index);
+			_mm_storeu_si128(Ptr, _mm_xor_si128(_mm_loadu_si128(Ptr), AllOnes));
+		}
+#endif
+		for (; Index < Count; ++Index)
+		{
+			Data[Index] = ~Data[Index];
+		}
+		ClearPartialSlackBits();
+	}
+
+	/** @return A & B, sized to the larger of the two. */
+	static TBitArray BitwiseAND(const TBitArray& A, const TBitArray& B)
+	{
+		TBitArray Result(A);
+		if (B.Num() > Result.Num())
+		{
+			Result.SetNum(B.Num(), false);
+		}
+		Result.CombineWithBitwiseAND(B);
+		return Result;
+	}
+
+	/** @return A | B, sized to the larger of the two. */
+	static TBitArray BitwiseOR(const TBitArray& A, const TBitArray& B)
+	{
+		TBitArray Result(A);
+		Result.CombineWithBitwiseOR(B);
+		return Result;
+	}
+
+	/** @return A ^ B, sized to the larger of the two. */
+	static TBitArray BitwiseXOR(const TBitArray& A, const TBitArray& B)
+	{
+		TBitArray Result(A);
+		Result.CombineWithBitwiseXOR(B);
+		return Result;
+	}
+
+	/** @return the number of bits which are set. */
+	SizeType CountSetBits() const
+	{
+		const std::uint64_t* RESTRICT Data = GetData();
+		SizeType NumSetBits = 0;
+		for (SizeType Index = 0, Count = NumWords(); Index < Count; ++Index)
+		{
+			NumSetBits += (SizeType)CountBits64(Data[Index]);
+		}
+		return NumSetBits;
+	}
+
+	/** @return true if any bit equals bValue. */
+	bool Contains(bool bValue) const
+	{
+		return (bValue ? FindFirstSetBit() : FindFirstClearBit()) != INDEX_NONE;
+	}
+
+	/** @return the index of the first set bit, or INDEX_NONE. */
+	SizeType FindFirstSetBit() const
+	{
+		return FindNextSetBit(0);
+	}
+
+	/** @return the index of the first clear bit, or INDEX_NONE. */
+	SizeType FindFirstClearBit() const
+	{
+		return FindNextClearBit(0);
+	}
+
+	/** @return the index of the first set bit at or after StartIndex, or INDEX_NONE. */
+	SizeType FindNextSetBit(SizeType StartIndex) const
+	{
+		return FindNextBit(StartIndex, 0);
+	}
+
+	/** @return the index of the first clear bit at or after StartIndex, or INDEX_NONE. */
+	SizeType FindNextClearBit(SizeType StartIndex) const
+	{
+		return FindNextBit(StartIndex, ~std::uint64_t(0));
+	}
+
+	/**
+	 * An iterator which only visits set bits. Each word is loaded once and
+	 * its set bits are peeled off lowest first, so runs of clear bits cost nothing.
+	 */
+	class TConstSetBitIterator
+	{
+	public:
+		explicit TConstSetBitIterator(const TBitArray& InArray, SizeType StartIndex = 0)
+			: Array(InArray)
+			, WordIndex(StartIndex / NumBitsPerWord)
+			, CurrentWord(0)
+			, CurrentBitIndex(InArray.Num())
+		{
+			if (StartIndex < Array.Num())
+			{
+				CurrentWord = Array.GetData()[WordIndex] & (~std::uint64_t(0) << (StartIndex % NumBitsPerWord));
+				FindNext();
+			}
+		}
+
+		TConstSetBitIterator& operator++()
+		{
+			CurrentWord &= CurrentWord - 1;
+			FindNext();
+			return *this;
+		}
+
+		/** conversion to "bool" returning true if the iterator is valid. */
+		explicit operator bool() const
+		{
+			return CurrentBitIndex < Array.Num();
+		}
+
+		/** @return the index of the current set bit. */
+		SizeType GetIndex() const
+		{
+			return CurrentBitIndex;
+		}
+
+		SizeType operator*() const
+		{
+			return CurrentBitIndex;
+		}
+
+		bool operator==(const TConstSetBitIterator& Rhs) const { return CurrentBitIndex == Rhs.CurrentBitIndex; }
+		bool operator!=(const TConstSetBitIterator& Rhs) const { return CurrentBitIndex != Rhs.CurrentBitIndex; }
+
+	private:
+		void FindNext()
+		{
+			while (!CurrentWord)
+			{
+				if (++WordIndex >= Array.NumWords())
+				{
+					CurrentBitIndex = Array.Num();
+					return;
+				}
+				CurrentWord = Array.GetData()[WordIndex];
+			}
+			CurrentBitIndex = WordIndex * NumBitsPerWord + (SizeType)CountTrailingZeros64(CurrentWord);
+		}
+
+		const TBitArray& Array;
+		SizeType         WordIndex;
+		std::uint64_t    CurrentWord;
+		SizeType         CurrentBitIndex;
+	};
+
+private:
+	template <EBitwiseOperator Operator>
+	static std::uint64_t CombineWord(std::uint64_t A, std::uint64_t B)
+	{
+		if constexpr (Operator == EBitwiseOperator::And)
+		{
+			return A & B;
+		}
+		else if constexpr (Operator == EBitwiseOperator::Or)
+		{
+			return A | B;
+		}
+		else
+		{
+			return A ^ B;
+		}
+	}
+
+	/** Dest[i] = Dest[i] Op Src[i] for Count words, a vector register at a time. */
+	template <EBitwiseOperator Operator>
+	static void CombineWords(std::uint64_t* RESTRICT Dest, const std::uint64_t* RESTRICT Src, SizeType Count)
+	{
+		SizeType Index = 0;
+#if BITARRAY_USE_AVX2
+		for (; Index + 4 <= Count; Index += 4)
+		{
+			const __m256i A = _mm256_loadu_si256((const __m256i*)(Dest + Index));
+			const __m256i B = _mm256_loadu_si256((const __m256i*)(Src + Index));
+			__m256i Result;
+			if constexpr (Operator == EBitwiseOperator::And)     { Result = _mm256_and_si256(A, B); }
+			else if constexpr (Operator == EBitwiseOperator::Or) { Result = _mm256_or_si256(A, B);  }
+			else                                                 { Result = _mm256_xor_si256(A, B); }
+			_mm256_storeu_si256((__m256i*)(Dest + Index), Result);
+		}
+#elif BITARRAY_USE_SSE2
+		for (; Index + 2 <= Count; Index += 2)
+		{
+			const __m128i A = _mm_loadu_si128((const __m128i*)(Dest + Index));
+			const __m128i B = _mm_loadu_si128((const __m128i*)(Src + Index));
+			__m128i Result;
+			if constexpr (Operator == EBitwiseOperator::And)     { Result = _mm_and_si128(A, B); }
+			else if constexpr (Operator == EBitwiseOperator::Or) { Result = _mm_or_si128(A, B);  }
+			else                                                 { Result = _mm_xor_si128(A, B); }
+			_mm_storeu_si128((__m128i*)(Dest + Index), Result);
+		}
+#endif
+		for (; Index < Count; ++Index)
+		{
+			Dest[Index] = CombineWord<Operator>(Dest[Index], Src[Index]);
+		}
+	}
+
+	/** Finds the next bit at or after StartIndex which differs from the bits of Invert. */
+	SizeType FindNextBit(SizeType StartIndex, std::uint64_t Invert) const
+	{
+		_ASSERT(StartIndex >= 0);
+		if (StartIndex >= NumBits)
+		{
+			return INDEX_NONE;
+		}
+
+		const std::uint64_t* RESTRICT Data = GetData();
+		SizeType WordIndex = StartIndex / NumBitsPerWord;
+		std::uint64_t Word = (Data[WordIndex] ^ Invert) & (~std::uint64_t(0) << (StartIndex % NumBitsPerWord));
+		while (!Word)
+		{
+			if (++WordIndex >= NumWords())
+			{
+				return INDEX_NONE;
+			}
+			Word = Data[WordIndex] ^ Invert;
+		}
+
+		// Inverted slack bits past the end can match; they are filtered here.
+		const SizeType Index = WordIndex * NumBitsPerWord + (SizeType)CountTrailingZeros64(Word);
+		return Index < NumBits ? Index : INDEX_NONE;
+	}
+
+	static std::uint64_t GetBitMask(SizeType Index)
+	{
+		return std::uint64_t(1) << (Index % NumBitsPerWord);
+	}
+
+	void ClearPartialSlackBits()
+	{
+		const SizeType UsedBits = NumBits % NumBitsPerWord;
+		if (UsedBits)
+		{
+			Words[NumBits / NumBitsPerWord] &= ~(~std::uint64_t(0) << UsedBits);
+		}
+	}
+
+	TArray<std::uint64_t> Words;
+	SizeType              NumBits;
+};
\ No newline at end of file
@@ -0,0 +1,516 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include "List.h"
+#include "Map.h"
+
+/** Hit/miss/eviction counters of a cache. */
+struct FCacheStats
+{
+	std::uint64_t NumHits      = 0;
+	std::uint64_t NumMisses    = 0;
+	std::uint64_t NumEvictions = 0;
+
+	double GetHitRate() const
+	{
+		const std::uint64_t NumLookups = NumHits + NumMisses;
+		return NumLookups ? double(NumHits) / double(NumLookups) : 0.0;
+	}
+
+	FCacheStats& operator+=(const FCacheStats& Other)
+	{
+		NumHits      += Other.NumHits;
+		NumMisses    += Other.NumMisses;
+		NumEvictions += Other.NumEvictions;
+		return *this;
+	}
+};
+
+/**
+ * Replacement policies for TCache. A policy is a class with a nested template ForList<ListType>, which the cache
+ * instantiates with its entry list and keeps as a member. The list holds the entries in the order the policy wants;
+ * ForList provides:
+ *
+ *		NodeType* Add(ListType& List, const EntryType& Entry);			// links a new entry in, returns its node
+ *		void      Touch(ListType& List, NodeType* Node);				// the entry was used
+ *		void      OnRemove(ListType& List, NodeType* Node);				// the entry is about to be removed from the list
+ *		NodeType* GetVictim(const ListType& List, NodeType* Keep);		// the entry to evict next, other than Keep
+ *		void      Reset();												// the list was emptied
+ */
+
+/** Least recently used: the list runs from the most recently used entry at the head to the victim at the tail. */
+struct FLruCachePolicy
+{
+	template <typename ListType>
+	class ForList
+	{
+		typedef typename ListType::TDoubleLinkedListNode NodeType;
+
+	public:
+		template <typename EntryType>
+		NodeType* Add(ListType& List, EntryType&& Entry)
+		{
+			return List.AddHead(std::forward<EntryType>(Entry));
+		}
+
+		void Touch(ListType& List, NodeType* Node)
+		{
+			if (Node != List.GetHead())
+			{
+				List.RemoveNode(Node, false);
+				List.AddHead(Node);
+			}
+		}
+
+		void OnRemove(ListType&, NodeType*)
+		{
+		}
+
+		NodeType* GetVictim(const ListType& List, NodeType* Keep) const
+		{
+			NodeType* Victim = List.GetTail();
+			return Victim && Victim == Keep ? Victim->GetPrevNode() : Victim;
+		}
+
+		void Reset()
+		{
+		}
+	};
+};
+
+/**
+ * Least frequently used, with ties going to the least recently used. The list is kept sorted by use count, from the
+ * victim at the head up; the entries with the same count form a run, ordered by when they were last used. A map from
+ * each count to the last node of its run finds where a used entry moves to in O(1), as its count only goes up by one.
+ */
+struct FLfuCachePolicy
+{
+	template <typename ListType>
+	class ForList
+	{
+		typedef typename ListType::TDoubleLinkedListNode NodeType;
+
+	public:
+		template <typename EntryType>
+		NodeType* Add(ListType& List, EntryType&& Entry)
+		{
+			_ASSERT(Entry.Frequency == 1);
+			NodeType* const* RunTail = RunTails.Find(1);
+			NodeType* Node = RunTail ? InsertAfter(List, std::forward<EntryType>(Entry), *RunTail) : List.AddHead(std::forward<EntryType>(Entry));
+			RunTails.Add(1, Node);
+			return Node;
+		}
+
+		void Touch(ListType& List, NodeType* Node)
+		{
+			const std::uint32_t Frequency = Node->GetValue().Frequency;
+			NodeType* Prev = Node->GetPrevNode();
+			OnRemove(List, Node);
+
+			// Move to the end of the next run up, or if there isn't one, to the end of the node's own run.
+			NodeType* After = Prev;
+			if (NodeType* const* NextRunTail = RunTails.Find(Frequency + 1))
+			{
+				After = *NextRunTail;
+			}
+			else if (NodeType* const* RunTail = RunTails.Find(Frequency))
+			{
+				After = *RunTail;
+			}
+
+			if (After != Prev)
+			{
+				List.RemoveNode(Node, false);
+				InsertAfter(List, Node, After);
+			}
+
+			Node->GetValue().Frequency = Frequency + 1;
+			RunTails.Add(Frequency + 1, Node);
+		}
+
+		void OnRemove(ListType&, NodeType* Node)
+		{
+			const std::uint32_t Frequency = Node->GetValue().Frequency;
+			NodeType** RunTail = RunTails.Find(Frequency);
+			_ASSERT(RunTail);
+			if (*RunTail == Node)
+			{
+				NodeType* Prev = Node->GetPrevNode();
+				if (Prev && Prev->GetValue().Frequency == Frequency)
+				{
+					*RunTail = Prev;
+				}
+				else
+				{
+					RunTails.Remove(Frequency);
+				}
+			}
+		}
+
+		NodeType* GetVictim(const ListType& List, NodeType* Keep) const
+		{
+			NodeType* Victim = List.GetHead();
+			return Victim && Victim == Keep ? Victim->GetNextNode() : Victim;
+		}
+
+		void Reset()
+		{
+			RunTails.Empty();
+		}
+
+	private:
+		template <typename ItemType>
+		static NodeType* InsertAfter(ListType& List, ItemType&& Item, NodeType* After)
+		{
+			NodeType* Next = After->GetNextNode();
+			return Next ? List.InsertNode(std::forward<ItemType>(Item), Next) : List.AddTail(std::forward<ItemType>(Item));
+		}
+
+		TMap<std::uint32_t, NodeType*> RunTails;
+	};
+};
+
+/**
+ * A bounded key/value cache. Entries are kept in a TDoubleLinkedList in the order PolicyType wants them evicted, with
+ * a TMap from each key to its node, so lookup, use, insertion and eviction are all O(1).
+ *
+ * The capacity is a total cost: give every entry a cost of 1 (the default) to bound the number of entries, or its
+ * size to bound the memory. Adding an entry evicts others until the total fits again; the entry just added is never
+ * evicted by its own Add, even if it alone is over the capacity.
+ *
+ * Not thread-safe; see TShardedCache.
+ */
+template <typename InKeyType, typename InValueType, typename PolicyType>
+class TCache
+{
+public:
+	typedef InKeyType   KeyType;
+	typedef InValueType ValueType;
+
+	/** Called with every entry evicted to make room, just before it is destroyed. */
+	typedef std::function<void(const KeyType&, ValueType&)> FEvictionCallback;
+
+private:
+	struct FEntry
+	{
+		KeyType       Key;
+		ValueType     Value;
+		std::int64_t  Cost;
+		std::uint32_t Frequency;
+	};
+
+	typedef TDoubleLinkedList<FEntry, TListNodePoolAllocator<>>      ListType;
+	typedef typename ListType::TDoubleLinkedListNode                 NodeType;
+	typedef typename PolicyType::template ForList<ListType>          ListPolicyType;
+
+public:
+	explicit TCache(std::int64_t InMaxCost)
+		: MaxCost(InMaxCost)
+		, TotalCost(0)
+	{
+		_ASSERT(MaxCost > 0);
+	}
+
+	TCache(const TCache&) = delete;
+	TCache& operator=(const TCache&) = delete;
+
+	void SetEvictionCallback(FEvictionCallback InOnEvicted)
+	{
+		OnEvicted = MoveTempIfPossible(InOnEvicted);
+	}
+
+	/**
+	 * Finds the value cached for Key, and counts it as used.
+	 *
+	 * @return The value, or nullptr on a miss. The pointer stays valid until the entry is removed or evicted.
+	 */
+	ValueType* Find(const KeyType& Key)
+	{
+		NodeType** Node = Index.Find(Key);
+		if (!Node)
+		{
+			++Stats.NumMisses;
+			return nullptr;
+		}
+
+		++Stats.NumHits;
+		ListPolicy.Touch(List, *Node);
+		return &(*Node)->GetValue().Value;
+	}
+
+	/** Finds the value cached for Key without counting it as used or updating the stats. */
+	const ValueType* Peek(const KeyType& Key) const
+	{
+		NodeType* const* Node = Index.Find(Key);
+		return Node ? &(*Node)->GetValue().Value : nullptr;
+	}
+
+	bool Contains(const KeyType& Key) const
+	{
+		return Index.Contains(Key);
+	}
+
+	/**
+	 * Caches Value for Key, replacing (and counting as used) any value already cached for it, then evicts entries
+	 * until the total cost fits the capacity.
+	 *
+	 * @param Cost The entry's share of the capacity.
+	 * @return The cached value.
+	 */
+	ValueType& Add(const KeyType& Key, const ValueType& Value, std::int64_t Cost = 1)
+	{
+		_ASSERT(Cost >= 0);
+
+		NodeType* Node;
+		if (NodeType** Existing = Index.Find(Key))
+		{
+			Node = *Existing;
+			FEntry& Entry = Node->GetValue();
+			TotalCost += Cost - Entry.Cost;
+			Entry.Value = Value;
+			Entry.Cost  = Cost;
+			ListPolicy.Touch(List, Node);
+		}
+		else
+		{
+			Node = ListPolicy.Add(List, FEntry{ Key, Value, Cost, 1 });
+			Index.Add(Key, Node);
+			TotalCost += Cost;
+		}
+
+		EvictToFit(Node);
+		return Node->GetValue().Value;
+	}
+
+	/**
+	 * Removes the entry for Key, without calling the eviction callback.
+	 *
+	 * @return Whether there was an entry for Key.
+	 */
+	bool Remove(const KeyType& Key)
+	{
+		NodeType** Node = Index.Find(Key);
+		if (!Node)
+		{
+			return false;
+		}
+		RemoveEntry(*Node);
+		return true;
+	}
+
+	/** Removes every entry, without calling the eviction callback. The stats are kept. */
+	void Empty()
+	{
+		List.Empty();
+		Index.Empty();
+		ListPolicy.Reset();
+		TotalCost = 0;
+	}
+
+	/** Changes the capacity, evicting entries if the cache is now over it. */
+	void SetMaxCost(std::int64_t InMaxCost)
+	{
+		_ASSERT(InMaxCost > 0);
+		MaxCost = InMaxCost;
+		EvictToFit(nullptr);
+	}
+
+	std::int64_t GetMaxCost() const
+	{
+		return MaxCost;
+	}
+
+	std::int64_t GetTotalCost() const
+	{
+		return TotalCost;
+	}
+
+	std::int32_t Num() const
+	{
+		return Index.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Index.IsEmpty();
+	}
+
+	const FCacheStats& GetStats() const
+	{
+		return Stats;
+	}
+
+	void ResetStats()
+	{
+		Stats = FCacheStats();
+	}
+
+private:
+	/** Evicts entries other than Keep until the total cost fits the capacity. */
+	void EvictToFit(NodeType* Keep)
+	{
+		while (TotalCost > MaxCost)
+		{
+			NodeType* Victim = ListPolicy.GetVictim(List, Keep);
+			if (!Victim)
+			{
+				break;
+			}
+
+			++Stats.NumEvictions;
+			if (OnEvicted)
+			{
+				FEntry& Entry = Victim->GetValue();
+				OnEvicted(Entry.Key, Entry.Value);
+			}
+			RemoveEntry(Victim);
+		}
+	}
+
+	void RemoveEntry(NodeType* Node)
+	{
+		FEntry& Entry = Node->GetValue();
+		TotalCost -= Entry.Cost;
+		Index.Remove(Entry.Key);
+		ListPolicy.OnRemove(List, Node);
+		List.RemoveNode(Node);
+	}
+
+	ListType                   List;
+	TMap<KeyType, NodeType*>   Index;
+	ListPolicyType             ListPolicy;
+	std::int64_t               MaxCost;
+	std::int64_t               TotalCost;
+	FCacheStats                Stats;
+	FEvictionCallback          OnEvicted;
+};
+
+template <typename KeyType, typename ValueType>
+using TLruCache = TCache<KeyType, ValueType, FLruCachePolicy>;
+
+template <typename KeyType, typename ValueType>
+using TLfuCache = TCache<KeyType, ValueType, FLfuCachePolicy>;
+
+/**
+ * A cache for concurrent use: keys are spread by hash over NumShards independent caches, each behind its own mutex,
+ * so threads working on different keys rarely wait for each other. Each shard gets an equal part of the capacity and
+ * evicts on its own, so eviction order is only approximate across the whole cache.
+ *
+ * Values are returned by copy, as a reference could be evicted by another thread as soon as the lock is released.
+ * The eviction callback runs with the shard locked and must not call back into the cache.
+ */
+template <typename CacheType, std::uint32_t NumShards = 16>
+class TShardedCache
+{
+	static_assert(NumShards && (NumShards & (NumShards - 1)) == 0, "NumShards must be a power of two");
+
+public:
+	typedef typename CacheType::KeyType           KeyType;
+	typedef typename CacheType::ValueType         ValueType;
+	typedef typename CacheType::FEvictionCallback FEvictionCallback;
+
+	explicit TShardedCache(std::int64_t MaxCost)
+	{
+		SetMaxCost(MaxCost);
+	}
+
+	void SetEvictionCallback(const FEvictionCallback& OnEvicted)
+	{
+		for (FShard& Shard : Shards)
+		{
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+			Shard.Cache.SetEvictionCallback(OnEvicted);
+		}
+	}
+
+	/** @return Whether Key was found, in which case its value is copied to OutValue. */
+	bool Find(const KeyType& Key, ValueType& OutValue)
+	{
+		FShard& Shard = GetShard(Key);
+		std::lock_guard<std::mutex> Lock(Shard.Mutex);
+		if (ValueType* Value = Shard.Cache.Find(Key))
+		{
+			OutValue = *Value;
+			return true;
+		}
+		return false;
+	}
+
+	void Add(const KeyType& Key, const ValueType& Value, std::int64_t Cost = 1)
+	{
+		FShard& Shard = GetShard(Key);
+		std::lock_guard<std::mutex> Lock(Shard.Mutex);
+		Shard.Cache.Add(Key, Value, Cost);
+	}
+
+	bool Remove(const KeyType& Key)
+	{
+		FShard& Shard = GetShard(Key);
+		std::lock_guard<std::mutex> Lock(Shard.Mutex);
+		return Shard.Cache.Remove(Key);
+	}
+
+	void Empty()
+	{
+		for (FShard& Shard : Shards)
+		{
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+			Shard.Cache.Empty();
+		}
+	}
+
+	/** Splits MaxCost evenly over the shards. */
+	void SetMaxCost(std::int64_t MaxCost)
+	{
+		const std::int64_t ShardMaxCost = MaxCost / NumShards > 0 ? MaxCost / NumShards : 1;
+		for (FShard& Shard : Shards)
+		{
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+			Shard.Cache.SetMaxCost(ShardMaxCost);
+		}
+	}
+
+	/** @return the number of entries; only a snapshot while other threads are using the cache. */
+	std::int32_t Num()
+	{
+		std::int32_t Result = 0;
+		for (FShard& Shard : Shards)
+		{
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+			Result += Shard.Cache.Num();
+		}
+		return Result;
+	}
+
+	/** @return the stats summed over every shard. */
+	FCacheStats GetStats()
+	{
+		FCacheStats Result;
+		for (FShard& Shard : Shards)
+		{
+			std::lock_guard<std::mutex> Lock(Shard.Mutex);
+			Result += Shard.Cache.GetStats();
+		}
+		return Result;
+	}
+
+private:
+	/** Shards sit on their own cache lines, so locking one doesn't slow down its neighbours. */
+	struct alignas(64) FShard
+	{
+		FShard()
+			: Cache(1)
+		{ }
+
+		std::mutex Mutex;
+		CacheType  Cache;
+	};
+
+	FShard& GetShard(const KeyType& Key)
+	{
+		// The maps inside the shards index by the low bits of the same hash, so pick the shard with the high ones.
+		return Shards[(GetTypeHash(Key) >> 32) & (NumShards - 1)];
+	}
+
+	FShard Shards[NumShards];
+};
\ No newline at end of file
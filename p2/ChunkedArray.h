@@ -0,0 +1,359 @@
+#pragma once
+#include "Array.h"
+
+/**
+ * An array which allocates its elements in fixed-size chunks, indexed through a small TArray of chunk pointers.
+ * Growing the array allocates a new chunk instead of reallocating, so existing elements never move: their
+ * addresses stay valid until they are removed, and there is no grow-copy of the whole array.
+ *
+ * The number of elements per chunk is a power of two, so indexing is a shift and a mask. Each chunk is
+ * contiguous; use ForEachChunk to run a tight (vectorizable) loop over each chunk in turn.
+ */
+template <typename InElementType, std::uint32_t TargetBytesPerChunk = 16384>
+class TChunkedArray
+{
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+private:
+	static constexpr SizeType CalculateElementsPerChunk()
+	{
+		SizeType Count = 1;
+		while (std::size_t(Count) * 2 * sizeof(ElementType) <= TargetBytesPerChunk)
+		{
+			Count *= 2;
+		}
+		return Count;
+	}
+
+	static constexpr SizeType CalculateChunkShift()
+	{
+		SizeType Shift = 0;
+		while ((SizeType(1) << Shift) < CalculateElementsPerChunk())
+		{
+			++Shift;
+		}
+		return Shift;
+	}
+
+public:
+	static constexpr SizeType NumElementsPerChunk = CalculateElementsPerChunk();
+	static constexpr SizeType ChunkShift          = CalculateChunkShift();
+	static constexpr SizeType ChunkMask           = NumElementsPerChunk - 1;
+
+	TChunkedArray()
+		: NumElements(0)
+	{ }
+
+	TChunkedArray(const TChunkedArray& Other)
+		: NumElements(0)
+	{
+		*this = Other;
+	}
+
+	TChunkedArray(TChunkedArray&& Other)
+		: Chunks(MoveTempIfPossible(Other.Chunks))
+		, NumElements(Other.NumElements)
+	{
+		Other.NumElements = 0;
+	}
+
+	~TChunkedArray()
+	{
+		Empty();
+	}
+
+	TChunkedArray& operator=(const TChunkedArray& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Reserve(Other.Num());
+			Other.ForEachChunk([this](const ElementType* ChunkData, SizeType ChunkNum)
+			{
+				ConstructItems<ElementType>(Chunks[NumElements >> ChunkShift], ChunkData, ChunkNum);
+				NumElements += ChunkNum;
+			});
+		}
+		return *this;
+	}
+
+	TChunkedArray& operator=(TChunkedArray&& Other)
+	{
+		if (this != &Other)
+		{
+			Empty();
+			Chunks = MoveTempIfPossible(Other.Chunks);
+			NumElements = Other.NumElements;
+			Other.NumElements = 0;
+		}
+		return *this;
+	}
+
+	ElementType& operator[](SizeType Index)
+	{
+		_ASSERT(Index >= 0 && Index < NumElements);
+		return Chunks[Index >> ChunkShift][Index & ChunkMask];
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		_ASSERT(Index >= 0 && Index < NumElements);
+		return Chunks[Index >> ChunkShift][Index & ChunkMask];
+	}
+
+	SizeType Num() const
+	{
+		return NumElements;
+	}
+
+	bool IsEmpty() const
+	{
+		return NumElements == 0;
+	}
+
+	/** @return the number of elements the allocated chunks can hold. */
+	SizeType Max() const
+	{
+		return Chunks.Num() * NumElementsPerChunk;
+	}
+
+	/**
+	 * Adds a new item to the end of the array without constructing it.
+	 * Never moves existing elements; at most one new chunk is allocated.
+	 *
+	 * @return Index to the new item
+	 */
+	SizeType AddUninitialized()
+	{
+		const SizeType Index = NumElements;
+		if ((Index >> ChunkShift) == Chunks.Num())
+		{
+			AllocateChunk();
+		}
+		++NumElements;
+		return Index;
+	}
+
+	template <typename... ArgsType>
+	SizeType Emplace(ArgsType&&... Args)
+	{
+		const SizeType Index = AddUninitialized();
+		new(&(*this)[Index]) ElementType(std::forward<ArgsType>(Args)...);
+		return Index;
+	}
+
+	SizeType Add(ElementType&& Item)
+	{
+		return Emplace(MoveTempIfPossible(Item));
+	}
+
+	SizeType Add(const ElementType& Item)
+	{
+		return Emplace(Item);
+	}
+
+	/**
+	 * Pops the last element from the array.  The chunk holding it is kept for reuse.
+	 *
+	 * @return Popped element.
+	 */
+	ElementType Pop()
+	{
+		_ASSERT(NumElements > 0);
+		ElementType& LastElement = (*this)[NumElements - 1];
+		ElementType Result = MoveTempIfPossible(LastElement);
+		DestructItem(&LastElement);
+		--NumElements;
+		return Result;
+	}
+
+	/** Allocates enough chunks to hold Number elements. */
+	void Reserve(SizeType Number)
+	{
+		_ASSERT(Number >= 0);
+		const SizeType NumChunksNeeded = (Number + NumElementsPerChunk - 1) >> ChunkShift;
+		Chunks.Reserve(NumChunksNeeded);
+		while (Chunks.Num() < NumChunksNeeded)
+		{
+			AllocateChunk();
+		}
+	}
+
+	/** Removes all elements and frees every chunk. */
+	void Empty()
+	{
+		Reset();
+		for (ElementType* Chunk : Chunks)
+		{
+			void* ChunkData = Chunk;
+			ResizeAllocation(ChunkData, 0, 0, sizeof(ElementType), &GetMemoryTypeTag<TChunkedArray>());
+		}
+		Chunks.Empty();
+	}
+
+	/** Removes all elements but keeps the chunks for reuse. */
+	void Reset()
+	{
+		ForEachChunk([](ElementType* ChunkData, SizeType ChunkNum)
+		{
+			DestructItems(ChunkData, ChunkNum);
+		});
+		NumElements = 0;
+	}
+
+	/** Frees the chunks past the last element. */
+	void Shrink()
+	{
+		const SizeType NumChunksNeeded = (NumElements + NumElementsPerChunk - 1) >> ChunkShift;
+		for (SizeType ChunkIndex = NumChunksNeeded; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+		{
+			void* ChunkData = Chunks[ChunkIndex];
+			ResizeAllocation(ChunkData, 0, 0, sizeof(ElementType), &GetMemoryTypeTag<TChunkedArray>());
+		}
+		Chunks.RemoveAt(NumChunksNeeded, Chunks.Num() - NumChunksNeeded);
+	}
+
+	/** @return the number of chunks which hold elements. */
+	SizeType NumChunks() const
+	{
+		return (NumElements + NumElementsPerChunk - 1) >> ChunkShift;
+	}
+
+	/** @return the contiguous elements of a chunk. */
+	ElementType* GetChunkData(SizeType ChunkIndex)
+	{
+		return Chunks[ChunkIndex];
+	}
+
+	const ElementType* GetChunkData(SizeType ChunkIndex) const
+	{
+		return Chunks[ChunkIndex];
+	}
+
+	/** @return the number of elements in a chunk; only the last chunk can be partially filled. */
+	SizeType GetChunkNum(SizeType ChunkIndex) const
+	{
+		const SizeType FirstIndex = ChunkIndex << ChunkShift;
+		const SizeType Remaining = NumElements - FirstIndex;
+		return Remaining < NumElementsPerChunk ? Remaining : NumElementsPerChunk;
+	}
+
+	/**
+	 * Calls Func(ElementType* ChunkData, SizeType ChunkNum) for each chunk in order.
+	 * Scans written this way see plain contiguous arrays and vectorize like a TArray loop would.
+	 */
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func)
+	{
+		for (SizeType ChunkIndex = 0, Count = NumChunks(); ChunkIndex < Count; ++ChunkIndex)
+		{
+			Invoke(Func, Chunks[ChunkIndex], GetChunkNum(ChunkIndex));
+		}
+	}
+
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func) const
+	{
+		for (SizeType ChunkIndex = 0, Count = NumChunks(); ChunkIndex < Count; ++ChunkIndex)
+		{
+			Invoke(Func, (const ElementType*)Chunks[ChunkIndex], GetChunkNum(ChunkIndex));
+		}
+	}
+
+	/**
+	 * Iterates the elements in order, walking a pointer through each chunk and
+	 * only going back to the chunk table when a chunk boundary is crossed.
+	 */
+	template <bool bConst>
+	class TBaseIterator
+	{
+		typedef std::conditional_t<bConst, const TChunkedArray, TChunkedArray> ArrayType;
+		typedef std::conditional_t<bConst, const ElementType, ElementType>     ItElementType;
+
+	public:
+		TBaseIterator(ArrayType& InArray, SizeType StartIndex)
+			: Array(&InArray)
+			, Index(StartIndex)
+			, Current(nullptr)
+			, ChunkEnd(nullptr)
+		{
+			if (Index < Array->Num())
+			{
+				Current = &(*Array)[Index];
+				ChunkEnd = Current + (NumElementsPerChunk - (Index & ChunkMask));
+			}
+		}
+
+		TBaseIterator& operator++()
+		{
+			++Index;
+			if (++Current == ChunkEnd && Index < Array->Num())
+			{
+				Current = &(*Array)[Index];
+				ChunkEnd = Current + NumElementsPerChunk;
+			}
+			return *this;
+		}
+
+		/** conversion to "bool" returning true if the iterator is valid. */
+		explicit operator bool() const
+		{
+			return Index < Array->Num();
+		}
+
+		SizeType GetIndex() const
+		{
+			return Index;
+		}
+
+		ItElementType& operator*() const
+		{
+			return *Current;
+		}
+
+		ItElementType* operator->() const
+		{
+			return Current;
+		}
+
+		bool operator==(const TBaseIterator& Rhs) const { return Index == Rhs.Index; }
+		bool operator!=(const TBaseIterator& Rhs) const { return Index != Rhs.Index; }
+
+	private:
+		ArrayType*     Array;
+		SizeType       Index;
+		ItElementType* Current;
+		ItElementType* ChunkEnd;
+	};
+
+	typedef TBaseIterator<false> TIterator;
+	typedef TBaseIterator<true>  TConstIterator;
+
+	TIterator CreateIterator()
+	{
+		return TIterator(*this, 0);
+	}
+
+	TConstIterator CreateConstIterator() const
+	{
+		return TConstIterator(*this, 0);
+	}
+
+private:
+	void AllocateChunk()
+	{
+		void* ChunkData = nullptr;
+		ResizeAllocation(ChunkData, 0, NumElementsPerChunk, sizeof(ElementType), &GetMemoryTypeTag<TChunkedArray>());
+		Chunks.Add((ElementType*)ChunkData);
+	}
+
+	TArray<ElementType*> Chunks;
+	SizeType             NumElements;
+
+	friend TIterator      begin(      TChunkedArray& Array) { return TIterator     (Array, 0); }
+	friend TConstIterator begin(const TChunkedArray& Array) { return TConstIterator(Array, 0); }
+	friend TIterator      end  (      TChunkedArray& Array) { return TIterator     (Array, Array.Num()); }
+	friend TConstIterator end  (const TChunkedArray& Array) { return TConstIterator(Array, Array.Num()); }
+};
@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include "Array.h"
+
+/**
+ * An append-only array which any number of threads can add to at once, without locks.
+ *
+ * Each Add reserves its slot with a single atomic fetch-add on the element count and constructs the element in place.
+ * Elements live in chunks that never move, chunk k holding FirstChunkSize << k elements, so a fixed table of 32 chunk
+ * pointers covers every index a 32-bit array can address. The first thread to need a chunk allocates it and publishes it
+ * with a compare-exchange; a thread that loses the race frees its allocation and uses the winner's.
+ *
+ * Every chunk counts the elements which have been fully constructed in it, so a chunk is complete once that count
+ * reaches the number of slots reserved in it.
+ *
+ * Once the producing threads are done, Consolidate() moves everything into a single contiguous TArray. Reading elements,
+ * Consolidate, Reset and Empty must not run concurrently with Add.
+ *
+ * Usage:
+ *		TConcurrentAppendArray<FResult> Results;
+ *		ParallelFor(..., [&](int32 Index) { Results.Add(Compute(Index)); });
+ *		TArray<FResult> AllResults = Results.Consolidate();
+ */
+template <typename InElementType, std::uint32_t FirstChunkSize = 256>
+class TConcurrentAppendArray
+{
+	static_assert(FirstChunkSize && (FirstChunkSize & (FirstChunkSize - 1)) == 0, "FirstChunkSize must be a power of two");
+
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	static constexpr std::uint32_t MaxChunks = 32;
+
+private:
+	/** Chunks are kept on separate cache lines so producers in different chunks don't contend. */
+	struct alignas(64) FChunk
+	{
+		std::atomic<ElementType*>   Data;
+		std::atomic<std::uint32_t>  NumPublished;
+	};
+
+public:
+	TConcurrentAppendArray()
+		: NumReserved(0)
+	{
+		for (FChunk& Chunk : Chunks)
+		{
+			Chunk.Data.store(nullptr, std::memory_order_relaxed);
+			Chunk.NumPublished.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	~TConcurrentAppendArray()
+	{
+		Empty();
+	}
+
+	TConcurrentAppendArray(const TConcurrentAppendArray&) = delete;
+	TConcurrentAppendArray& operator=(const TConcurrentAppendArray&) = delete;
+
+	/**
+	 * Constructs a new element at the end of the array. Thread-safe.
+	 *
+	 * @return Index of the new element.
+	 */
+	template <typename... ArgsType>
+	SizeType Emplace(ArgsType&&... Args)
+	{
+		const std::uint32_t Index = NumReserved.fetch_add(1, std::memory_order_relaxed);
+		_ASSERT(Index < (std::uint32_t)INT32_MAX);
+
+		const std::uint32_t ChunkIndex = GetChunkIndex(Index);
+		ElementType* ChunkData = GetOrAllocateChunk(ChunkIndex);
+		new(ChunkData + (Index - GetChunkStart(ChunkIndex))) ElementType(std::forward<ArgsType>(Args)...);
+		Chunks[ChunkIndex].NumPublished.fetch_add(1, std::memory_order_release);
+		return (SizeType)Index;
+	}
+
+	SizeType Add(const ElementType& Item)
+	{
+		return Emplace(Item);
+	}
+
+	SizeType Add(ElementType&& Item)
+	{
+		return Emplace(MoveTempIfPossible(Item));
+	}
+
+	/**
+	 * Copies Count elements to the end of the array as one contiguous block, with a single reservation. Thread-safe.
+	 * Batching this way is much cheaper than adding one at a time when a thread produces several results.
+	 *
+	 * @return Index of the first added element.
+	 */
+	SizeType Append(const ElementType* Items, SizeType Count)
+	{
+		_ASSERT(Count >= 0);
+		const std::uint32_t FirstIndex = NumReserved.fetch_add((std::uint32_t)Count, std::memory_order_relaxed);
+		_ASSERT(std::uint64_t(FirstIndex) + Count <= (std::uint64_t)INT32_MAX);
+
+		std::uint32_t Index = FirstIndex;
+		const std::uint32_t EndIndex = FirstIndex + (std::uint32_t)Count;
+		while (Index < EndIndex)
+		{
+			const std::uint32_t ChunkIndex = GetChunkIndex(Index);
+			const std::uint32_t ChunkStart = GetChunkStart(ChunkIndex);
+			const std::uint32_t ChunkEnd   = ChunkStart + GetChunkSize(ChunkIndex);
+			const std::uint32_t NumInChunk = (EndIndex < ChunkEnd ? EndIndex : ChunkEnd) - Index;
+
+			ElementType* ChunkData = GetOrAllocateChunk(ChunkIndex);
+			ConstructItems<ElementType>(ChunkData + (Index - ChunkStart), Items, NumInChunk);
+			Chunks[ChunkIndex].NumPublished.fetch_add(NumInChunk, std::memory_order_release);
+
+			Items += NumInChunk;
+			Index += NumInChunk;
+		}
+		return (SizeType)FirstIndex;
+	}
+
+	/** @return the number of elements added so far, including ones other threads are still constructing. */
+	SizeType Num() const
+	{
+		return (SizeType)NumReserved.load(std::memory_order_relaxed);
+	}
+
+	bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < Num();
+	}
+
+	/** @return true if every element reserved so far has been fully constructed. */
+	bool IsComplete() const
+	{
+		std::uint32_t Remaining = NumReserved.load(std::memory_order_acquire);
+		for (std::uint32_t ChunkIndex = 0; Remaining; ++ChunkIndex)
+		{
+			const std::uint32_t NumInChunk = Remaining < GetChunkSize(ChunkIndex) ? Remaining : GetChunkSize(ChunkIndex);
+			if (Chunks[ChunkIndex].NumPublished.load(std::memory_order_acquire) != NumInChunk)
+			{
+				return false;
+			}
+			Remaining -= NumInChunk;
+		}
+		return true;
+	}
+
+	/**
+	 * Element access. Only valid for elements whose Add has returned, and only once that is
+	 * visible to this thread (e.g. after joining the producers).
+	 */
+	ElementType& operator[](SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		const std::uint32_t ChunkIndex = GetChunkIndex((std::uint32_t)Index);
+		return Chunks[ChunkIndex].Data.load(std::memory_order_acquire)[(std::uint32_t)Index - GetChunkStart(ChunkIndex)];
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		return const_cast<TConcurrentAppendArray&>(*this)[Index];
+	}
+
+	/**
+	 * Moves every element into one contiguous array, in index order, and resets this array.
+	 * The chunks are kept, so the next round of producers doesn't need to allocate again.
+	 * Must not be called while other threads are adding.
+	 */
+	TArray<ElementType> Consolidate()
+	{
+		_ASSERT(IsComplete());
+
+		TArray<ElementType> Result;
+		Result.Reserve(Num());
+
+		ForEachChunk([&Result](ElementType* ChunkData, std::uint32_t NumInChunk)
+		{
+			const SizeType Index = Result.AddUninitialized((SizeType)NumInChunk);
+			RelocateConstructItems<ElementType>(Result.GetData() + Index, ChunkData, NumInChunk);
+		});
+
+		ResetChunkCounters();
+		return Result;
+	}
+
+	/** Removes all elements but keeps the chunks. Must not be called while other threads are adding. */
+	void Reset()
+	{
+		_ASSERT(IsComplete());
+		ForEachChunk([](ElementType* ChunkData, std::uint32_t NumInChunk)
+		{
+			DestructItems(ChunkData, NumInChunk);
+		});
+		ResetChunkCounters();
+	}
+
+	/** Removes all elements and frees every chunk. Must not be called while other threads are adding. */
+	void Empty()
+	{
+		Reset();
+		for (std::uint32_t ChunkIndex = 0; ChunkIndex < MaxChunks; ++ChunkIndex)
+		{
+			void* ChunkData = Chunks[ChunkIndex].Data.exchange(nullptr, std::memory_order_relaxed);
+			if (ChunkData)
+			{
+				ResizeAllocation(ChunkData, GetChunkSize(ChunkIndex), 0, sizeof(ElementType), &GetMemoryTypeTag<TConcurrentAppendArray>());
+			}
+		}
+	}
+
+private:
+	/** @return the chunk which holds the element at Index. */
+	static std::uint32_t GetChunkIndex(std::uint32_t Index)
+	{
+		return FloorLog2(Index / FirstChunkSize + 1);
+	}
+
+	/** @return the index of the first element in the chunk. */
+	static std::uint32_t GetChunkStart(std::uint32_t ChunkIndex)
+	{
+		return (std::uint32_t)((std::uint64_t(1) << ChunkIndex) - 1) * FirstChunkSize;
+	}
+
+	/** @return the number of elements the chunk can hold, without going past the largest valid index. */
+	static std::uint32_t GetChunkSize(std::uint32_t ChunkIndex)
+	{
+		const std::uint64_t Start = ((std::uint64_t(1) << ChunkIndex) - 1) * FirstChunkSize;
+		const std::uint64_t Size  = std::uint64_t(FirstChunkSize) << ChunkIndex;
+		return Start + Size <= (std::uint64_t)INT32_MAX ? (std::uint32_t)Size : (std::uint32_t)((std::uint64_t)INT32_MAX - Start);
+	}
+
+	ElementType* GetOrAllocateChunk(std::uint32_t ChunkIndex)
+	{
+		std::atomic<ElementType*>& ChunkData = Chunks[ChunkIndex].Data;
+		ElementType* Existing = ChunkData.load(std::memory_order_acquire);
+		if (Existing)
+		{
+			return Existing;
+		}
+
+		void* NewData = nullptr;
+		ResizeAllocation(NewData, 0, GetChunkSize(ChunkIndex), sizeof(ElementType), &GetMemoryTypeTag<TConcurrentAppendArray>());
+		if (ChunkData.compare_exchange_strong(Existing, (ElementType*)NewData, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			return (ElementType*)NewData;
+		}
+
+		// Another thread published this chunk first.
+		ResizeAllocation(NewData, GetChunkSize(ChunkIndex), 0, sizeof(ElementType), &GetMemoryTypeTag<TConcurrentAppendArray>());
+		return Existing;
+	}
+
+	/** Calls Func(ChunkData, NumInChunk) for every chunk which holds elements, in index order. */
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func)
+	{
+		std::uint32_t Remaining = NumReserved.load(std::memory_order_acquire);
+		for (std::uint32_t ChunkIndex = 0; Remaining; ++ChunkIndex)
+		{
+			const std::uint32_t NumInChunk = Remaining < GetChunkSize(ChunkIndex) ? Remaining : GetChunkSize(ChunkIndex);
+			Func(Chunks[ChunkIndex].Data.load(std::memory_order_relaxed), NumInChunk);
+			Remaining -= NumInChunk;
+		}
+	}
+
+	void ResetChunkCounters()
+	{
+		for (FChunk& Chunk : Chunks)
+		{
+			Chunk.NumPublished.store(0, std::memory_order_relaxed);
+		}
+		NumReserved.store(0, std::memory_order_relaxed);
+	}
+
+	/** Kept on its own cache line: every producer hits it. */
+	alignas(64) std::atomic<std::uint32_t> NumReserved;
+	FChunk                                 Chunks[MaxChunks];
+};
@@ -0,0 +1,326 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * The hook an object embeds to be linked into a TIntrusiveDoubleLinkedList. A hook can be in one list at a time; an
+ * object which needs to be in several lists at once embeds one hook per list.
+ */
+class FIntrusiveListLink
+{
+public:
+	FIntrusiveListLink()
+		: NextLink(nullptr)
+		, PrevLink(nullptr)
+	{ }
+
+	/** Unlinks the object if it is still in a list, so a list never points at a destroyed object. */
+	~FIntrusiveListLink()
+	{
+		Unlink();
+	}
+
+	/** Copies of an object start out unlinked. */
+	FIntrusiveListLink(const FIntrusiveListLink&)
+		: NextLink(nullptr)
+		, PrevLink(nullptr)
+	{ }
+
+	FIntrusiveListLink& operator=(const FIntrusiveListLink&)
+	{
+		return *this;
+	}
+
+	bool IsLinked() const
+	{
+		return NextLink != nullptr;
+	}
+
+	/** Removes the object from whichever list it is in, in O(1), without needing the list. Does nothing if it isn't linked. */
+	void Unlink()
+	{
+		if (NextLink)
+		{
+			NextLink->PrevLink = PrevLink;
+			PrevLink->NextLink = NextLink;
+			NextLink = PrevLink = nullptr;
+		}
+	}
+
+private:
+	template <typename, typename> friend class TIntrusiveDoubleLinkedListIterator;
+	template <typename T, FIntrusiveListLink T::*> friend class TIntrusiveDoubleLinkedList;
+
+	/** Links this hook in before Next. */
+	void LinkBefore(FIntrusiveListLink* Next)
+	{
+		NextLink = Next;
+		PrevLink = Next->PrevLink;
+		PrevLink->NextLink = this;
+		Next->PrevLink = this;
+	}
+
+	FIntrusiveListLink* NextLink;
+	FIntrusiveListLink* PrevLink;
+};
+
+/** Iterates over a TIntrusiveDoubleLinkedList, with the same interface as TDoubleLinkedListIterator. */
+template <typename ListType, typename ElementType>
+class TIntrusiveDoubleLinkedListIterator
+{
+public:
+	TIntrusiveDoubleLinkedListIterator(const FIntrusiveListLink* InSentinel, const FIntrusiveListLink* StartingLink)
+		: CurrentLink(const_cast<FIntrusiveListLink*>(StartingLink))
+		, Sentinel(InSentinel)
+	{ }
+
+	/** conversion to "bool" returning true if the iterator is valid. */
+	explicit operator bool() const
+	{
+		return CurrentLink != Sentinel;
+	}
+
+	TIntrusiveDoubleLinkedListIterator& operator++()
+	{
+		_ASSERT(CurrentLink != Sentinel);
+		CurrentLink = CurrentLink->NextLink;
+		return *this;
+	}
+
+	TIntrusiveDoubleLinkedListIterator operator++(int)
+	{
+		auto Tmp = *this;
+		++(*this);
+		return Tmp;
+	}
+
+	TIntrusiveDoubleLinkedListIterator& operator--()
+	{
+		_ASSERT(CurrentLink != Sentinel);
+		CurrentLink = CurrentLink->PrevLink;
+		return *this;
+	}
+
+	TIntrusiveDoubleLinkedListIterator operator--(int)
+	{
+		auto Tmp = *this;
+		--(*this);
+		return Tmp;
+	}
+
+	// Accessors.
+	ElementType* operator->() const
+	{
+		return GetNode();
+	}
+
+	ElementType& operator*() const
+	{
+		return *GetNode();
+	}
+
+	/** The "node" of an intrusive list is the object itself. */
+	ElementType* GetNode() const
+	{
+		_ASSERT(CurrentLink != Sentinel);
+		return ListType::GetElement(CurrentLink);
+	}
+
+	bool operator==(const TIntrusiveDoubleLinkedListIterator& Rhs) const { return CurrentLink == Rhs.CurrentLink; }
+	bool operator!=(const TIntrusiveDoubleLinkedListIterator& Rhs) const { return CurrentLink != Rhs.CurrentLink; }
+
+private:
+	FIntrusiveListLink*       CurrentLink;
+	const FIntrusiveListLink* Sentinel;
+};
+
+/**
+ * A doubly linked list of objects which embed their own FIntrusiveListLink, e.g.:
+ *
+ *		struct FRequest
+ *		{
+ *			FIntrusiveListLink PendingLink;
+ *			...
+ *		};
+ *		TIntrusiveDoubleLinkedList<FRequest, &FRequest::PendingLink> PendingRequests;
+ *
+ * Adding and removing never allocates or copies: the list links the objects where they are, and doesn't own them.
+ * The list is circular around a sentinel link inside the list object, so every link always has neighbours and an
+ * object can unlink itself in O(1) (Link.Unlink()) without knowing which list it is in. The flip side is that the
+ * list can't keep a count: Num() walks the list and is O(n); use IsEmpty() where that is all you need.
+ *
+ * The list can't be copied or moved, as the objects point at its sentinel.
+ */
+template <typename InElementType, FIntrusiveListLink InElementType::*LinkMember>
+class TIntrusiveDoubleLinkedList
+{
+public:
+	typedef InElementType ElementType;
+
+	typedef TIntrusiveDoubleLinkedListIterator<TIntrusiveDoubleLinkedList,       ElementType> TIterator;
+	typedef TIntrusiveDoubleLinkedListIterator<TIntrusiveDoubleLinkedList, const ElementType> TConstIterator;
+
+	TIntrusiveDoubleLinkedList()
+	{
+		Sentinel.NextLink = Sentinel.PrevLink = &Sentinel;
+	}
+
+	/** Unlinks every object left in the list. */
+	~TIntrusiveDoubleLinkedList()
+	{
+		Empty();
+		Sentinel.NextLink = Sentinel.PrevLink = nullptr;
+	}
+
+	TIntrusiveDoubleLinkedList(const TIntrusiveDoubleLinkedList&) = delete;
+	TIntrusiveDoubleLinkedList& operator=(const TIntrusiveDoubleLinkedList&) = delete;
+
+	// Adding/Removing methods
+
+	/**
+	 * Links Element in at the beginning of the list. It must not be in a list already.
+	 *
+	 * @see GetHead, InsertNode, RemoveNode
+	 */
+	void AddHead(ElementType& Element)
+	{
+		GetLink(Element).LinkBefore(Sentinel.NextLink);
+	}
+
+	void AddTail(ElementType& Element)
+	{
+		GetLink(Element).LinkBefore(&Sentinel);
+	}
+
+	/**
+	 * Links Element in before NodeToInsertBefore, or at the head of the list if that is nullptr.
+	 * Element must not be in a list already, and NodeToInsertBefore must be in this one.
+	 */
+	void InsertNode(ElementType& Element, ElementType* NodeToInsertBefore = nullptr)
+	{
+		if (NodeToInsertBefore == nullptr)
+		{
+			AddHead(Element);
+			return;
+		}
+
+		_ASSERT(GetLink(*NodeToInsertBefore).IsLinked());
+		GetLink(Element).LinkBefore(&GetLink(*NodeToInsertBefore));
+	}
+
+	/** Unlinks Element, which must be in this list. Same as calling Unlink on its link. */
+	void RemoveNode(ElementType& Element)
+	{
+		_ASSERT(GetLink(Element).IsLinked());
+		GetLink(Element).Unlink();
+	}
+
+	/** Unlinks every object. O(n), as every hook is reset. */
+	void Empty()
+	{
+		while (Sentinel.NextLink != &Sentinel)
+		{
+			Sentinel.NextLink->Unlink();
+		}
+	}
+
+	// Accessors.
+
+	/** @return the object at the head of the list, or nullptr if it is empty. */
+	ElementType* GetHead() const
+	{
+		return Sentinel.NextLink != &Sentinel ? GetElement(Sentinel.NextLink) : nullptr;
+	}
+
+	/** @return the object at the end of the list, or nullptr if it is empty. */
+	ElementType* GetTail() const
+	{
+		return Sentinel.PrevLink != &Sentinel ? GetElement(Sentinel.PrevLink) : nullptr;
+	}
+
+	/** @return the object after Element, or nullptr if Element is the tail. */
+	ElementType* GetNextNode(const ElementType& Element) const
+	{
+		const FIntrusiveListLink* Next = GetLink(Element).NextLink;
+		return Next != &Sentinel ? GetElement(Next) : nullptr;
+	}
+
+	/** @return the object before Element, or nullptr if Element is the head. */
+	ElementType* GetPrevNode(const ElementType& Element) const
+	{
+		const FIntrusiveListLink* Prev = GetLink(Element).PrevLink;
+		return Prev != &Sentinel ? GetElement(Prev) : nullptr;
+	}
+
+	/** @return true if Element is in this list. O(n); use GetLink(Element).IsLinked() if it can only be in this one. */
+	bool Contains(const ElementType& Element) const
+	{
+		for (const FIntrusiveListLink* Link = Sentinel.NextLink; Link != &Sentinel; Link = Link->NextLink)
+		{
+			if (Link == &GetLink(Element))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool IsEmpty() const
+	{
+		return Sentinel.NextLink == &Sentinel;
+	}
+
+	/** @return the number of objects in the list. O(n): the list doesn't keep a count, see the class comment. */
+	std::int32_t Num() const
+	{
+		std::int32_t Count = 0;
+		for (const FIntrusiveListLink* Link = Sentinel.NextLink; Link != &Sentinel; Link = Link->NextLink)
+		{
+			++Count;
+		}
+		return Count;
+	}
+
+	/** @return an iterator starting at Element, which must be in this list. */
+	TIterator CreateIterator(ElementType& Element)
+	{
+		return TIterator(&Sentinel, &GetLink(Element));
+	}
+
+	static FIntrusiveListLink& GetLink(ElementType& Element)
+	{
+		return Element.*LinkMember;
+	}
+
+	static const FIntrusiveListLink& GetLink(const ElementType& Element)
+	{
+		return Element.*LinkMember;
+	}
+
+	/** @return the object which embeds Link. */
+	static ElementType* GetElement(const FIntrusiveListLink* Link)
+	{
+		return (ElementType*)((const unsigned char*)Link - GetLinkOffset());
+	}
+
+private:
+	/** @return the offset of the link inside ElementType, measured on storage which is never constructed. */
+	static std::ptrdiff_t GetLinkOffset()
+	{
+		alignas(ElementType) static unsigned char Storage[sizeof(ElementType)];
+		const ElementType* Element = reinterpret_cast<const ElementType*>(Storage);
+		return (const unsigned char*)&(Element->*LinkMember) - Storage;
+	}
+
+	const FIntrusiveListLink* GetFirstLink() const
+	{
+		return Sentinel.NextLink;
+	}
+
+	FIntrusiveListLink Sentinel;
+
+	friend TIterator      begin(      TIntrusiveDoubleLinkedList& List) { return TIterator     (&List.Sentinel, List.GetFirstLink()); }
+	friend TConstIterator begin(const TIntrusiveDoubleLinkedList& List) { return TConstIterator(&List.Sentinel, List.GetFirstLink()); }
+	friend TIterator      end  (      TIntrusiveDoubleLinkedList& List) { return TIterator     (&List.Sentinel, &List.Sentinel); }
+	friend TConstIterator end  (const TIntrusiveDoubleLinkedList& List) { return TConstIterator(&List.Sentinel, &List.Sentinel); }
+};
\ No newline at end of file
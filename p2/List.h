@@ -1,5 +1,6 @@
 #pragma once
 #include <typeinfo>
+#include "ListNodeAllocator.h"
 
 template <class NodeType, class ElementType>
 class TDoubleLinkedListIterator
@@ -70,7 +71,11 @@ private:
 	NodeType* CurrentNode;
 };
 
-template <class ElementType>
+/**
+ * A doubly linked list. Nodes are allocated through AllocatorType, see ListNodeAllocator.h; pass
+ * TListNodePoolAllocator<> for lists with a lot of insert/remove churn.
+ */
+template <class ElementType, class AllocatorType = FDefaultListNodeAllocator>
 class TDoubleLinkedList
 {
 public:
@@ -79,9 +84,10 @@ public:
 	public:
 		friend class TDoubleLinkedList;
 
-		/** Constructor */
-		TDoubleLinkedListNode( const ElementType& InValue )
-			: Value(InValue), NextNode(nullptr), PrevNode(nullptr)
+		/** Constructs the value in place from Args, so the list can hold move-only and non-copyable elements. */
+		template <typename... ArgsType>
+		explicit TDoubleLinkedListNode( ArgsType&&... Args )
+			: Value(std::forward<ArgsType>(Args)...), NextNode(nullptr), PrevNode(nullptr)
 		{ }
 
 		const ElementType& GetValue() const
@@ -150,7 +156,12 @@ public:
 	 */
 	TDoubleLinkedListNode* AddHead( const ElementType& InElement )
 	{
-		return AddHead(new TDoubleLinkedListNode(InElement));
+		return AddHead(CreateNode(InElement));
+	}
+
+	TDoubleLinkedListNode* AddHead( ElementType&& InElement )
+	{
+		return AddHead(CreateNode(MoveTempIfPossible(InElement)));
 	}
 
 	TDoubleLinkedListNode* AddHead( TDoubleLinkedListNode* NewNode )
@@ -178,7 +189,12 @@ public:
 
 	TDoubleLinkedListNode* AddTail( const ElementType& InElement )
 	{
-		return AddTail(new TDoubleLinkedListNode(InElement));
+		return AddTail(CreateNode(InElement));
+	}
+
+	TDoubleLinkedListNode* AddTail( ElementType&& InElement )
+	{
+		return AddTail(CreateNode(MoveTempIfPossible(InElement)));
 	}
 
 	TDoubleLinkedListNode* AddTail( TDoubleLinkedListNode* NewNode )
@@ -205,7 +221,12 @@ public:
 
 	TDoubleLinkedListNode* InsertNode( const ElementType& InElement, TDoubleLinkedListNode* NodeToInsertBefore=nullptr )
 	{
-		return InsertNode(new TDoubleLinkedListNode(InElement), NodeToInsertBefore);
+		return InsertNode(CreateNode(InElement), NodeToInsertBefore);
+	}
+
+	TDoubleLinkedListNode* InsertNode( ElementType&& InElement, TDoubleLinkedListNode* NodeToInsertBefore=nullptr )
+	{
+		return InsertNode(CreateNode(MoveTempIfPossible(InElement)), NodeToInsertBefore);
 	}
 
 	TDoubleLinkedListNode* InsertNode( TDoubleLinkedListNode* NewNode, TDoubleLinkedListNode* NodeToInsertBefore=nullptr )
@@ -230,6 +251,54 @@ public:
 		return NewNode;
 	}
 
+	/**
+	 * Constructs a new element in place at the beginning of the list, without copying or moving it.
+	 *
+	 * @param	Args	the arguments to the element's constructor.
+	 * @return	the new node.
+	 * @see EmplaceTail, EmplaceBefore
+	 */
+	template <typename... ArgsType>
+	TDoubleLinkedListNode* EmplaceHead( ArgsType&&... Args )
+	{
+		return AddHead(CreateNode(std::forward<ArgsType>(Args)...));
+	}
+
+	template <typename... ArgsType>
+	TDoubleLinkedListNode* EmplaceTail( ArgsType&&... Args )
+	{
+		return AddTail(CreateNode(std::forward<ArgsType>(Args)...));
+	}
+
+	/** Constructs a new element in place before NodeToInsertBefore, or at the head of the list if that is nullptr, like InsertNode. */
+	template <typename... ArgsType>
+	TDoubleLinkedListNode* EmplaceBefore( TDoubleLinkedListNode* NodeToInsertBefore, ArgsType&&... Args )
+	{
+		return InsertNode(CreateNode(std::forward<ArgsType>(Args)...), NodeToInsertBefore);
+	}
+
+	/**
+	 * Removes the head of the list, which must not be empty, and moves its value out.
+	 *
+	 * @return	the value which was at the head.
+	 * @see PopTail
+	 */
+	ElementType PopHead()
+	{
+		_ASSERT(HeadNode != nullptr);
+		ElementType Result(MoveTempIfPossible(HeadNode->Value));
+		RemoveNode(HeadNode);
+		return Result;
+	}
+
+	ElementType PopTail()
+	{
+		_ASSERT(TailNode != nullptr);
+		ElementType Result(MoveTempIfPossible(TailNode->Value));
+		RemoveNode(TailNode);
+		return Result;
+	}
+
 	/**
 	 * Remove the node corresponding to InElement.
 	 *
@@ -252,24 +321,14 @@ public:
 	{
 		if ( NodeToRemove != nullptr )
 		{
-			// if we only have one node, just call Clear() so that we don't have to do lots of extra checks in the code below
+			// Removing the only node doesn't go through Empty(), so a pooled allocator keeps its slabs for the next add.
 			if ( Num() == 1 )
 			{
 				_ASSERT(NodeToRemove == HeadNode);
-				if (bDeleteNode)
-				{
-					Empty();
-				}
-				else
-				{
-					NodeToRemove->NextNode = NodeToRemove->PrevNode = nullptr;
-					HeadNode = TailNode = nullptr;
-					SetListSize(0);
-				}
-				return;
+				HeadNode = TailNode = nullptr;
 			}
 
-			if ( NodeToRemove == HeadNode )
+			else if ( NodeToRemove == HeadNode )
 			{
 				HeadNode = HeadNode->NextNode;
 				HeadNode->PrevNode = nullptr;
@@ -288,7 +347,7 @@ public:
 
 			if (bDeleteNode)
 			{
-				delete NodeToRemove;
+				DestroyNode(NodeToRemove);
 			}
 			else
 			{
@@ -298,21 +357,188 @@ public:
 		}
 	}
 
-	/** Removes all nodes from the list. */
+	/**
+	 * Removes all nodes from the list. If the allocator can release all of its nodes at once, the nodes are only
+	 * destructed (not even that for trivially destructible elements) and freed in bulk.
+	 */
 	void Empty()
 	{
 		TDoubleLinkedListNode* Node;
-		while ( HeadNode != nullptr )
+		if ( NodeAllocator.CanFreeAll(ListSize) )
 		{
-			Node = HeadNode->NextNode;
-			delete HeadNode;
-			HeadNode = Node;
+			if ( !std::is_trivially_destructible<ElementType>::value )
+			{
+				while ( HeadNode != nullptr )
+				{
+					Node = HeadNode->NextNode;
+					HeadNode->~TDoubleLinkedListNode();
+					HeadNode = Node;
+				}
+			}
+			NodeAllocator.FreeAll();
+		}
+		else
+		{
+			while ( HeadNode != nullptr )
+			{
+				Node = HeadNode->NextNode;
+				DestroyNode(HeadNode);
+				HeadNode = Node;
+			}
 		}
 
 		HeadNode = TailNode = nullptr;
 		SetListSize(0);
 	}
 
+	// Relinking methods. None of these allocate, copy or move elements: they only rewire the nodes.
+
+	/**
+	 * Moves the nodes from First to Last (inclusive) out of Source and inserts them before NodeToInsertBefore in
+	 * this list. Source may be this list, as long as NodeToInsertBefore isn't inside the range.
+	 * Source must be this list unless NodeAllocatorType::bNodesMoveBetweenLists is true; as that depends on which
+	 * list is passed, it is only checked at runtime.
+	 *
+	 * @param	NodeToInsertBefore	where to insert the nodes; nullptr inserts them at the end of the list.
+	 * @param	NumNodes			the number of nodes in the range, if known. Otherwise moving them between two lists
+	 *								counts them, which is the only part of the splice that isn't O(1).
+	 */
+	void Splice( TDoubleLinkedListNode* NodeToInsertBefore, TDoubleLinkedList& Source, TDoubleLinkedListNode* First, TDoubleLinkedListNode* Last, std::int32_t NumNodes = -1 )
+	{
+		_ASSERT(First != nullptr && Last != nullptr);
+		_ASSERT(&Source == this || NodeAllocatorType::bNodesMoveBetweenLists);
+
+		if ( &Source != this && NumNodes < 0 )
+		{
+			NumNodes = 1;
+			for ( TDoubleLinkedListNode* Node = First; Node != Last; Node = Node->NextNode )
+			{
+				++NumNodes;
+			}
+		}
+
+		// Unlink the range from the source...
+		( First->PrevNode ? First->PrevNode->NextNode : Source.HeadNode ) = Last->NextNode;
+		( Last->NextNode ? Last->NextNode->PrevNode : Source.TailNode ) = First->PrevNode;
+
+		// ...and link it in before NodeToInsertBefore.
+		TDoubleLinkedListNode* Prev = NodeToInsertBefore ? NodeToInsertBefore->PrevNode : TailNode;
+		First->PrevNode = Prev;
+		Last->NextNode = NodeToInsertBefore;
+		( Prev ? Prev->NextNode : HeadNode ) = First;
+		( NodeToInsertBefore ? NodeToInsertBefore->PrevNode : TailNode ) = Last;
+
+		if ( &Source != this )
+		{
+			Source.SetListSize(Source.ListSize - NumNodes);
+			SetListSize(ListSize + NumNodes);
+		}
+	}
+
+	/**
+	 * Moves a single node out of Source and inserts it before NodeToInsertBefore (nullptr for the end). O(1).
+	 * Source must be this list unless NodeAllocatorType::bNodesMoveBetweenLists is true (checked at runtime).
+	 */
+	void Splice( TDoubleLinkedListNode* NodeToInsertBefore, TDoubleLinkedList& Source, TDoubleLinkedListNode* Node )
+	{
+		Splice(NodeToInsertBefore, Source, Node, Node, 1);
+	}
+
+	/**
+	 * Moves every node out of Source and inserts them before NodeToInsertBefore (nullptr for the end). O(1).
+	 * Source is always another list, so this needs an allocator which allows moving nodes between lists.
+	 */
+	void Splice( TDoubleLinkedListNode* NodeToInsertBefore, TDoubleLinkedList& Source )
+	{
+		static_assert(NodeAllocatorType::bNodesMoveBetweenLists, "This list's node allocator doesn't allow moving nodes between lists");
+		_ASSERT(&Source != this);
+		if ( Source.HeadNode != nullptr )
+		{
+			Splice(NodeToInsertBefore, Source, Source.HeadNode, Source.TailNode, Source.ListSize);
+		}
+	}
+
+	/**
+	 * Sorts the list with a bottom-up merge sort, which only relinks nodes. Stable, O(n log n), and needs no memory
+	 * besides the list.
+	 *
+	 * @param	Predicate	returns true if its first argument should come before its second.
+	 */
+	template <typename PredicateType>
+	void Sort( const PredicateType& Predicate )
+	{
+		// Merge runs of Width nodes pairwise, treating the list as singly linked, then fix up the back links once.
+		for ( std::int32_t Width = 1; Width < ListSize; Width *= 2 )
+		{
+			TDoubleLinkedListNode* Remaining = HeadNode;
+			TDoubleLinkedListNode* MergedHead = nullptr;
+			TDoubleLinkedListNode* MergedTail = nullptr;
+			while ( Remaining != nullptr )
+			{
+				TDoubleLinkedListNode* Left = Remaining;
+				TDoubleLinkedListNode* Right = CutAfter(Left, Width);
+				Remaining = CutAfter(Right, Width);
+
+				TDoubleLinkedListNode* RunTail;
+				TDoubleLinkedListNode* Run = MergeRuns(Left, Right, Predicate, RunTail);
+				( MergedTail ? MergedTail->NextNode : MergedHead ) = Run;
+				MergedTail = RunTail;
+			}
+			HeadNode = MergedHead;
+		}
+		RelinkPrevNodes();
+	}
+
+	void Sort()
+	{
+		Sort(TLess<ElementType>());
+	}
+
+	/**
+	 * Merges the nodes of Other into this list, leaving Other empty. Both lists must be sorted by Predicate, and the
+	 * result is too; of equal elements, the ones from this list come first. O(n + m).
+	 * Needs an allocator which allows moving nodes between lists (see bNodesMoveBetweenLists).
+	 */
+	template <typename PredicateType>
+	void Merge( TDoubleLinkedList& Other, const PredicateType& Predicate )
+	{
+		static_assert(NodeAllocatorType::bNodesMoveBetweenLists, "This list's node allocator doesn't allow moving nodes between lists");
+		_ASSERT(&Other != this);
+		if ( Other.HeadNode == nullptr )
+		{
+			return;
+		}
+
+		TDoubleLinkedListNode* MergedTail;
+		HeadNode = MergeRuns(HeadNode, Other.HeadNode, Predicate, MergedTail);
+		RelinkPrevNodes();
+
+		const std::int32_t NumMoved = Other.ListSize;
+		Other.HeadNode = Other.TailNode = nullptr;
+		Other.SetListSize(0);
+		SetListSize(ListSize + NumMoved);
+	}
+
+	void Merge( TDoubleLinkedList& Other )
+	{
+		Merge(Other, TLess<ElementType>());
+	}
+
+	/** Reverses the order of the nodes. */
+	void Reverse()
+	{
+		for ( TDoubleLinkedListNode* Node = HeadNode; Node != nullptr; Node = Node->PrevNode )
+		{
+			TDoubleLinkedListNode* Next = Node->NextNode;
+			Node->NextNode = Node->PrevNode;
+			Node->PrevNode = Next;
+		}
+
+		TDoubleLinkedListNode* OldHead = HeadNode;
+		HeadNode = TailNode;
+		TailNode = OldHead;
+	}
+
 	// Accessors.
 
 	/**
@@ -399,6 +625,74 @@ protected:
 	}
 
 private:
+	typedef typename AllocatorType::template ForNodeType<TDoubleLinkedListNode> NodeAllocatorType;
+
+	template <typename... ArgsType>
+	TDoubleLinkedListNode* CreateNode( ArgsType&&... Args )
+	{
+		return new(NodeAllocator.Allocate()) TDoubleLinkedListNode(std::forward<ArgsType>(Args)...);
+	}
+
+	void DestroyNode( TDoubleLinkedListNode* Node )
+	{
+		Node->~TDoubleLinkedListNode();
+		NodeAllocator.Free(Node);
+	}
+
+	/** Cuts a singly linked run after its first Count nodes, and returns the rest (or nullptr). */
+	static TDoubleLinkedListNode* CutAfter( TDoubleLinkedListNode* Node, std::int32_t Count )
+	{
+		for ( ; Node != nullptr && Count > 1; --Count )
+		{
+			Node = Node->NextNode;
+		}
+		if ( Node == nullptr )
+		{
+			return nullptr;
+		}
+
+		TDoubleLinkedListNode* Rest = Node->NextNode;
+		Node->NextNode = nullptr;
+		return Rest;
+	}
+
+	/** Merges two sorted, nullptr-terminated runs by their next links only. Ties take the node from Left first. */
+	template <typename PredicateType>
+	static TDoubleLinkedListNode* MergeRuns( TDoubleLinkedListNode* Left, TDoubleLinkedListNode* Right, const PredicateType& Predicate, TDoubleLinkedListNode*& OutTail )
+	{
+		TDoubleLinkedListNode* Head = nullptr;
+		TDoubleLinkedListNode** Link = &Head;
+		OutTail = nullptr;
+		while ( Left != nullptr && Right != nullptr )
+		{
+			TDoubleLinkedListNode*& Next = Predicate(Right->Value, Left->Value) ? Right : Left;
+			*Link = OutTail = Next;
+			Link = &Next->NextNode;
+			Next = Next->NextNode;
+		}
+
+		*Link = Left ? Left : Right;
+		while ( *Link != nullptr )
+		{
+			OutTail = *Link;
+			Link = &OutTail->NextNode;
+		}
+		return Head;
+	}
+
+	/** Rebuilds the back links and the tail from the next links, after a sort or merge. */
+	void RelinkPrevNodes()
+	{
+		TDoubleLinkedListNode* Prev = nullptr;
+		for ( TDoubleLinkedListNode* Node = HeadNode; Node != nullptr; Node = Node->NextNode )
+		{
+			Node->PrevNode = Prev;
+			Prev = Node;
+		}
+		TailNode = Prev;
+	}
+
+	NodeAllocatorType      NodeAllocator;
 	TDoubleLinkedListNode* HeadNode;
 	TDoubleLinkedListNode* TailNode;
 	std::int32_t ListSize;
@@ -0,0 +1,330 @@
+#pragma once
+#include <new>
+#include <mutex>
+#include "Util.h"
+
+/**
+ * Node allocator policies for TDoubleLinkedList.
+ *
+ * A policy is a class with a nested template ForNodeType<NodeType>, which the list instantiates with its node type and
+ * keeps as a member. ForNodeType provides:
+ *
+ *		void* Allocate();							// storage for one node, which the list constructs in place
+ *		void  Free(void* Node);						// storage of one node, already destructed
+ *		bool  CanFreeAll(int32 NumNodesInList);		// true if every node this allocator handed out is in the list
+ *		void  FreeAll();							// releases every node at once, after the list destructed them
+ *		static constexpr bool bNodesMoveBetweenLists;	// whether another list's allocator may free this one's nodes
+ *
+ * Nodes passed to the list by pointer (AddHead(Node) etc.) end up freed by the list's allocator, so with anything
+ * but the default policy they must have come from the same list, e.g. through RemoveNode(Node, false).
+ */
+
+/**
+ * Allocates every node on its own, with global operator new, like `new TDoubleLinkedListNode`. These nodes bypass the
+ * memory layer (see Memory.h) and don't show up in its reports; the pooled allocators below are tracked.
+ */
+class FDefaultListNodeAllocator
+{
+public:
+	template <typename NodeType>
+	class ForNodeType
+	{
+	public:
+		static constexpr bool bNodesMoveBetweenLists = true;
+
+		void* Allocate()
+		{
+			return ::operator new(sizeof(NodeType));
+		}
+
+		void Free(void* Node)
+		{
+			::operator delete(Node);
+		}
+
+		bool CanFreeAll(std::int32_t) const
+		{
+			return false;
+		}
+
+		void FreeAll()
+		{
+		}
+	};
+};
+
+namespace ListNodeAllocatorImpl
+{
+	/** Storage for one node, or a link in the free list while the node isn't in use. */
+	template <typename NodeType>
+	union TNodeSlot
+	{
+		TNodeSlot* NextFree;
+		alignas(NodeType) unsigned char Storage[sizeof(NodeType)];
+	};
+
+	/** A block of contiguous node slots. */
+	template <typename NodeType, std::int32_t NodesPerSlab>
+	struct TSlab
+	{
+		TNodeSlot<NodeType> Slots[NodesPerSlab];
+		TSlab*              NextSlab;
+	};
+
+	template <typename NodeType, std::int32_t NodesPerSlab>
+	TSlab<NodeType, NodesPerSlab>* AllocateSlab(TSlab<NodeType, NodesPerSlab>* NextSlab)
+	{
+		static_assert(alignof(NodeType) <= 16, "List nodes aligned beyond 16 bytes are not supported by the pool allocators");
+
+		void* Data = nullptr;
+		ResizeAllocation(Data, 0, 1, sizeof(TSlab<NodeType, NodesPerSlab>), &GetMemoryTypeTag<NodeType>());
+		TSlab<NodeType, NodesPerSlab>* Slab = (TSlab<NodeType, NodesPerSlab>*)Data;
+		Slab->NextSlab = NextSlab;
+		return Slab;
+	}
+
+	template <typename NodeType, std::int32_t NodesPerSlab>
+	void FreeSlabs(TSlab<NodeType, NodesPerSlab>* Slab)
+	{
+		while (Slab)
+		{
+			void* Data = Slab;
+			Slab = Slab->NextSlab;
+			ResizeAllocation(Data, 1, 0, sizeof(TSlab<NodeType, NodesPerSlab>), &GetMemoryTypeTag<NodeType>());
+		}
+	}
+}
+
+/**
+ * Gives each list its own pool of nodes, carved out of slabs of NodesPerSlab contiguous nodes. Freed nodes go on a
+ * free list and are reused before the current slab is carved any further, so steady insert/remove churn allocates
+ * nothing, and nodes added one after another sit next to each other in memory.
+ *
+ * Slabs are only released when the list is emptied (or destroyed) with all of its nodes in it: Empty() then just
+ * destructs the elements, skipping even that for trivially destructible ones, and frees the slabs in one go.
+ */
+template <std::int32_t NodesPerSlab = 64>
+class TListNodePoolAllocator
+{
+	static_assert(NodesPerSlab > 0, "NodesPerSlab must be positive");
+
+public:
+	template <typename NodeType>
+	class ForNodeType
+	{
+		typedef ListNodeAllocatorImpl::TNodeSlot<NodeType>           FNodeSlot;
+		typedef ListNodeAllocatorImpl::TSlab<NodeType, NodesPerSlab> FSlab;
+
+	public:
+		/** Nodes belong to the slabs of the list which allocated them. */
+		static constexpr bool bNodesMoveBetweenLists = false;
+
+		ForNodeType()
+			: Slabs(nullptr)
+			, FreeList(nullptr)
+			, NumCarvedInSlab(NodesPerSlab)
+			, NumAllocated(0)
+		{ }
+
+		~ForNodeType()
+		{
+			_ASSERT(NumAllocated == 0);
+			ListNodeAllocatorImpl::FreeSlabs(Slabs);
+		}
+
+		ForNodeType(const ForNodeType&) = delete;
+		ForNodeType& operator=(const ForNodeType&) = delete;
+
+		void* Allocate()
+		{
+			++NumAllocated;
+			if (FNodeSlot* Slot = FreeList)
+			{
+				FreeList = Slot->NextFree;
+				return Slot;
+			}
+
+			if (NumCarvedInSlab == NodesPerSlab)
+			{
+				Slabs = ListNodeAllocatorImpl::AllocateSlab(Slabs);
+				NumCarvedInSlab = 0;
+			}
+			return &Slabs->Slots[NumCarvedInSlab++];
+		}
+
+		void Free(void* Node)
+		{
+			_ASSERT(NumAllocated > 0);
+			FNodeSlot* Slot = (FNodeSlot*)Node;
+			Slot->NextFree = FreeList;
+			FreeList = Slot;
+			--NumAllocated;
+		}
+
+		bool CanFreeAll(std::int32_t NumNodesInList) const
+		{
+			return NumAllocated == NumNodesInList;
+		}
+
+		void FreeAll()
+		{
+			ListNodeAllocatorImpl::FreeSlabs(Slabs);
+			Slabs           = nullptr;
+			FreeList        = nullptr;
+			NumCarvedInSlab = NodesPerSlab;
+			NumAllocated    = 0;
+		}
+
+		/** @return the number of nodes handed out and not freed yet. */
+		std::int32_t GetNumAllocated() const
+		{
+			return NumAllocated;
+		}
+
+	private:
+		FSlab*       Slabs;
+		FNodeSlot*   FreeList;
+		std::int32_t NumCarvedInSlab;
+		std::int32_t NumAllocated;
+	};
+};
+
+/**
+ * Shares the nodes of every list with the same node type through one global pool, with a cache of free nodes per
+ * thread in front of it. Allocate and Free only touch the calling thread's cache; the pool's lock is taken once per
+ * MaxCachedNodes / 2 nodes, to refill an empty cache or to hand back half of a full one. A node may be freed on a
+ * different thread from the one which allocated it.
+ *
+ * Use this for many short-lived lists, which a per-list pool would keep allocating fresh slabs for. Slabs are kept
+ * for the lifetime of the process and reused by every list of the type, so there is no bulk release in Empty().
+ */
+template <std::int32_t NodesPerSlab = 64, std::int32_t MaxCachedNodes = 256>
+class TThreadCachedListNodeAllocator
+{
+	static_assert(NodesPerSlab > 0 && MaxCachedNodes >= 2, "Invalid pool sizes");
+
+public:
+	template <typename NodeType>
+	class ForNodeType
+	{
+		typedef ListNodeAllocatorImpl::TNodeSlot<NodeType>           FNodeSlot;
+		typedef ListNodeAllocatorImpl::TSlab<NodeType, NodesPerSlab> FSlab;
+
+		static constexpr std::int32_t BatchSize = MaxCachedNodes / 2;
+
+		struct FSharedPool
+		{
+			std::mutex Mutex;
+			FSlab*     Slabs    = nullptr;
+			FNodeSlot* FreeList = nullptr;
+
+			/** Moves up to BatchSize free nodes into the cache, carving a new slab if the pool has none. */
+			void Refill(FNodeSlot*& CacheList, std::int32_t& NumCached)
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				if (!FreeList)
+				{
+					Slabs = ListNodeAllocatorImpl::AllocateSlab(Slabs);
+					for (std::int32_t Index = NodesPerSlab - 1; Index >= 0; --Index)
+					{
+						Slabs->Slots[Index].NextFree = FreeList;
+						FreeList = &Slabs->Slots[Index];
+					}
+				}
+
+				while (FreeList && NumCached < BatchSize)
+				{
+					FNodeSlot* Slot = FreeList;
+					FreeList = Slot->NextFree;
+					Slot->NextFree = CacheList;
+					CacheList = Slot;
+					++NumCached;
+				}
+			}
+
+			/** Hands Count nodes from the front of the cache back to the pool. */
+			void Drain(FNodeSlot*& CacheList, std::int32_t& NumCached, std::int32_t Count)
+			{
+				if (Count == 0)
+				{
+					return;
+				}
+
+				// Find the end of the batch outside the lock, then splice it in whole.
+				FNodeSlot* First = CacheList;
+				FNodeSlot* Last  = First;
+				for (std::int32_t Index = 1; Index < Count; ++Index)
+				{
+					Last = Last->NextFree;
+				}
+				CacheList = Last->NextFree;
+				NumCached -= Count;
+
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Last->NextFree = FreeList;
+				FreeList = First;
+			}
+		};
+
+		struct FThreadCache
+		{
+			FNodeSlot*   FreeList  = nullptr;
+			std::int32_t NumCached = 0;
+
+			~FThreadCache()
+			{
+				GetSharedPool().Drain(FreeList, NumCached, NumCached);
+			}
+		};
+
+		static FSharedPool& GetSharedPool()
+		{
+			static FSharedPool Pool;
+			return Pool;
+		}
+
+		static FThreadCache& GetThreadCache()
+		{
+			thread_local FThreadCache Cache;
+			return Cache;
+		}
+
+	public:
+		static constexpr bool bNodesMoveBetweenLists = true;
+
+		void* Allocate()
+		{
+			FThreadCache& Cache = GetThreadCache();
+			if (!Cache.FreeList)
+			{
+				GetSharedPool().Refill(Cache.FreeList, Cache.NumCached);
+			}
+
+			FNodeSlot* Slot = Cache.FreeList;
+			Cache.FreeList = Slot->NextFree;
+			--Cache.NumCached;
+			return Slot;
+		}
+
+		void Free(void* Node)
+		{
+			FThreadCache& Cache = GetThreadCache();
+			FNodeSlot* Slot = (FNodeSlot*)Node;
+			Slot->NextFree = Cache.FreeList;
+			Cache.FreeList = Slot;
+			if (++Cache.NumCached > MaxCachedNodes)
+			{
+				GetSharedPool().Drain(Cache.FreeList, Cache.NumCached, BatchSize);
+			}
+		}
+
+		bool CanFreeAll(std::int32_t) const
+		{
+			return false;
+		}
+
+		void FreeAll()
+		{
+		}
+	};
+};
\ No newline at end of file
@@ -0,0 +1,569 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include "Array.h"
+#include "ListNodeAllocator.h"
+
+/** The hook an object embeds to be pushed onto a TIntrusiveMpscQueue. */
+struct FMpscQueueLink
+{
+	std::atomic<FMpscQueueLink*> NextLink{ nullptr };
+};
+
+/**
+ * Dmitry Vyukov's intrusive multi-producer, single-consumer queue. Objects embed an FMpscQueueLink and are linked
+ * in place, so the queue never allocates:
+ *
+ *		struct FJob
+ *		{
+ *			FMpscQueueLink QueueLink;
+ *			...
+ *		};
+ *		TIntrusiveMpscQueue<FJob, &FJob::QueueLink> Jobs;
+ *
+ * Push is wait-free: one atomic exchange and one store, from any number of threads. Pop must only be called from one
+ * thread at a time and is lock-free; it can return nullptr while a push it would have to return is halfway done (a
+ * producer preempted between its exchange and its store), so a consumer which has been told there is work should
+ * retry rather than assume the queue is empty.
+ *
+ * A pushed object must stay alive until it is popped. The queue doesn't own its objects: anything left in it when
+ * it is destroyed is just forgotten.
+ */
+template <typename InElementType, FMpscQueueLink InElementType::*LinkMember>
+class TIntrusiveMpscQueue
+{
+public:
+	typedef InElementType ElementType;
+
+	TIntrusiveMpscQueue()
+		: Head(&Stub)
+		, Tail(&Stub)
+	{ }
+
+	TIntrusiveMpscQueue(const TIntrusiveMpscQueue&) = delete;
+	TIntrusiveMpscQueue& operator=(const TIntrusiveMpscQueue&) = delete;
+
+	/** Adds Element at the back of the queue. Thread-safe. */
+	void Push(ElementType& Element)
+	{
+		PushLink(&(Element.*LinkMember));
+	}
+
+	/**
+	 * Removes the element at the front of the queue. Consumer thread only.
+	 *
+	 * @return the element, or nullptr if the queue is empty or its next element isn't fully pushed yet.
+	 */
+	ElementType* Pop()
+	{
+		FMpscQueueLink* First = Tail;
+		FMpscQueueLink* Next  = First->NextLink.load(std::memory_order_acquire);
+
+		// Step over the stub, which is only in the queue to keep it from ever being truly empty.
+		if (First == &Stub)
+		{
+			if (Next == nullptr)
+			{
+				return nullptr;
+			}
+			Tail  = Next;
+			First = Next;
+			Next  = Next->NextLink.load(std::memory_order_acquire);
+		}
+
+		if (Next != nullptr)
+		{
+			Tail = Next;
+			return GetElement(First);
+		}
+
+		// First is the last link. If a producer has swapped in a newer one but not linked it yet, come back later.
+		if (First != Head.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		// Put the stub back behind First, so First can be handed out without leaving the queue without a link.
+		PushLink(&Stub);
+		Next = First->NextLink.load(std::memory_order_acquire);
+		if (Next != nullptr)
+		{
+			Tail = Next;
+			return GetElement(First);
+		}
+		return nullptr;
+	}
+
+	/** @return true if there is nothing to pop. Consumer thread only; a concurrent push may have just made it false. */
+	bool IsEmpty() const
+	{
+		return Tail == &Stub && Stub.NextLink.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	void PushLink(FMpscQueueLink* Link)
+	{
+		Link->NextLink.store(nullptr, std::memory_order_relaxed);
+		FMpscQueueLink* Prev = Head.exchange(Link, std::memory_order_acq_rel);
+		Prev->NextLink.store(Link, std::memory_order_release);
+	}
+
+	/** @return the element which embeds Link, see TIntrusiveDoubleLinkedList::GetElement. */
+	static ElementType* GetElement(FMpscQueueLink* Link)
+	{
+		alignas(ElementType) static unsigned char Storage[sizeof(ElementType)];
+		const std::ptrdiff_t LinkOffset = (unsigned char*)&(reinterpret_cast<ElementType*>(Storage)->*LinkMember) - Storage;
+		return (ElementType*)((unsigned char*)Link - LinkOffset);
+	}
+
+	/** The producers' end; kept on its own cache line, away from the consumer. */
+	alignas(64) std::atomic<FMpscQueueLink*> Head;
+	alignas(64) FMpscQueueLink*              Tail;
+	FMpscQueueLink                           Stub;
+};
+
+/**
+ * A multi-producer, single-consumer queue of values, on top of TIntrusiveMpscQueue. Each value is wrapped in a node
+ * from a pool with a cache per thread (see TThreadCachedListNodeAllocator), so enqueuing and dequeuing don't call
+ * malloc once the pool is warm, even when nodes are freed on a different thread from the one which allocated them.
+ */
+template <typename InElementType>
+class TMpscQueue
+{
+public:
+	typedef InElementType ElementType;
+
+private:
+	struct FNode
+	{
+		template <typename... ArgsType>
+		explicit FNode(ArgsType&&... Args)
+			: Value(std::forward<ArgsType>(Args)...)
+		{ }
+
+		FMpscQueueLink Link;
+		ElementType    Value;
+	};
+
+	typedef typename TThreadCachedListNodeAllocator<>::template ForNodeType<FNode> NodeAllocatorType;
+
+public:
+	TMpscQueue() = default;
+
+	~TMpscQueue()
+	{
+		while (FNode* Node = Nodes.Pop())
+		{
+			DestroyNode(Node);
+		}
+	}
+
+	TMpscQueue(const TMpscQueue&) = delete;
+	TMpscQueue& operator=(const TMpscQueue&) = delete;
+
+	/** Adds a value at the back of the queue, constructed from Args. Thread-safe. */
+	template <typename... ArgsType>
+	void Enqueue(ArgsType&&... Args)
+	{
+		Nodes.Push(*new(NodeAllocatorType().Allocate()) FNode(std::forward<ArgsType>(Args)...));
+	}
+
+	/**
+	 * Moves the value at the front of the queue into OutValue. Consumer thread only.
+	 *
+	 * @return false if there was nothing to dequeue (see TIntrusiveMpscQueue::Pop).
+	 */
+	bool Dequeue(ElementType& OutValue)
+	{
+		FNode* Node = Nodes.Pop();
+		if (Node == nullptr)
+		{
+			return false;
+		}
+		OutValue = MoveTempIfPossible(Node->Value);
+		DestroyNode(Node);
+		return true;
+	}
+
+	bool IsEmpty() const
+	{
+		return Nodes.IsEmpty();
+	}
+
+private:
+	static void DestroyNode(FNode* Node)
+	{
+		Node->~FNode();
+		NodeAllocatorType().Free(Node);
+	}
+
+	TIntrusiveMpscQueue<FNode, &FNode::Link> Nodes;
+};
+
+/**
+ * Hazard pointers (Maged Michael, 2004): safe memory reclamation for lock-free structures whose nodes other threads
+ * may still be reading after they have been unlinked.
+ *
+ * Before dereferencing a shared node, a thread publishes its address in one of its hazard slots with Protect. A
+ * thread which unlinks a node Retires it instead of freeing it; once a thread has retired enough nodes, it frees all
+ * of them which no thread has in a hazard slot. Up to MaxThreads threads can hold hazard slots at once; a thread
+ * claims its slots on first use and gives them up when it exits.
+ */
+class FHazardPointers
+{
+public:
+	static constexpr std::int32_t MaxThreads     = 256;
+	static constexpr std::int32_t SlotsPerThread = 2;
+
+	typedef void (*FReclaimFunction)(void*);
+
+	/**
+	 * Loads Source into hazard slot Slot, repeating until the published value is still the current one, so the node
+	 * can't have been retired before it was protected.
+	 *
+	 * @return the protected pointer.
+	 */
+	template <typename T>
+	static T* Protect(std::int32_t Slot, const std::atomic<T*>& Source)
+	{
+		std::atomic<void*>& Hazard = GetThreadState().Record->Slots[Slot];
+		T* Ptr = Source.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Hazard.store(Ptr, std::memory_order_seq_cst);
+			T* Current = Source.load(std::memory_order_seq_cst);
+			if (Current == Ptr)
+			{
+				return Ptr;
+			}
+			Ptr = Current;
+		}
+	}
+
+	/** Publishes Ptr in hazard slot Slot. The caller must check that Ptr is still reachable afterwards. */
+	static void Set(std::int32_t Slot, void* Ptr)
+	{
+		GetThreadState().Record->Slots[Slot].store(Ptr, std::memory_order_seq_cst);
+	}
+
+	static void Clear(std::int32_t Slot)
+	{
+		GetThreadState().Record->Slots[Slot].store(nullptr, std::memory_order_release);
+	}
+
+	/** Hands over an unlinked node, to be passed to Reclaim once no thread has it in a hazard slot. */
+	static void Retire(void* Ptr, FReclaimFunction Reclaim)
+	{
+		FThreadState& State = GetThreadState();
+		State.Retired.Add(FRetired{ Ptr, Reclaim });
+
+		const std::int32_t NumHazards = GetDomain().NumRecordsUsed.load(std::memory_order_relaxed) * SlotsPerThread;
+		if (State.Retired.Num() >= 2 * NumHazards + 64)
+		{
+			Scan(State.Retired);
+		}
+	}
+
+private:
+	struct alignas(64) FRecord
+	{
+		std::atomic<void*> Slots[SlotsPerThread];
+		std::atomic<bool>  bInUse;
+	};
+
+	struct FRetired
+	{
+		void*            Ptr;
+		FReclaimFunction Reclaim;
+	};
+
+	struct FDomain
+	{
+		FRecord                   Records[MaxThreads] = {};
+		std::atomic<std::int32_t> NumRecordsUsed{ 0 };
+
+		/** Nodes retired by threads which exited before they could be reclaimed; the next Scan adopts them. */
+		std::mutex                Mutex;
+		TArray<FRetired>          Orphans;
+	};
+
+	struct FThreadState
+	{
+		FThreadState()
+		{
+			FDomain& Domain = GetDomain();
+			for (std::int32_t Index = 0; Index < MaxThreads; ++Index)
+			{
+				if (!Domain.Records[Index].bInUse.load(std::memory_order_relaxed) && !Domain.Records[Index].bInUse.exchange(true, std::memory_order_acquire))
+				{
+					Record = &Domain.Records[Index];
+					std::int32_t NumUsed = Domain.NumRecordsUsed.load(std::memory_order_relaxed);
+					while (NumUsed <= Index && !Domain.NumRecordsUsed.compare_exchange_weak(NumUsed, Index + 1, std::memory_order_relaxed))
+					{
+					}
+					return;
+				}
+			}
+			_ASSERT(!"More than FHazardPointers::MaxThreads threads are using hazard pointers");
+			Record = nullptr;
+		}
+
+		/**
+		 * Leaves the nodes this thread couldn't reclaim yet to the other threads. Reclaiming them here could call into
+		 * other thread-local state (such as a node pool's cache) which may already be gone.
+		 */
+		~FThreadState()
+		{
+			// A thread which found no free record never used hazard pointers (nor retired anything).
+			if (!Record)
+			{
+				return;
+			}
+
+			for (std::atomic<void*>& Slot : Record->Slots)
+			{
+				Slot.store(nullptr, std::memory_order_release);
+			}
+			if (Retired.Num())
+			{
+				FDomain& Domain = GetDomain();
+				std::lock_guard<std::mutex> Lock(Domain.Mutex);
+				Domain.Orphans.Insert(Retired, Domain.Orphans.Num());
+			}
+			Record->bInUse.store(false, std::memory_order_release);
+		}
+
+		FRecord*         Record;
+		TArray<FRetired> Retired;
+	};
+
+	static FDomain& GetDomain()
+	{
+		static FDomain Domain;
+		return Domain;
+	}
+
+	static FThreadState& GetThreadState()
+	{
+		thread_local FThreadState State;
+		return State;
+	}
+
+	/** Reclaims every node in Retired which isn't in anyone's hazard slot, and keeps the rest. */
+	static void Scan(TArray<FRetired>& Retired)
+	{
+		FDomain& Domain = GetDomain();
+		if (Domain.Mutex.try_lock())
+		{
+			Retired.Insert(Domain.Orphans, Retired.Num());
+			Domain.Orphans.Reset();
+			Domain.Mutex.unlock();
+		}
+
+		TArray<void*> Hazards;
+		const std::int32_t NumRecords = Domain.NumRecordsUsed.load(std::memory_order_acquire);
+		for (std::int32_t Index = 0; Index < NumRecords; ++Index)
+		{
+			for (std::atomic<void*>& Slot : Domain.Records[Index].Slots)
+			{
+				if (void* Hazard = Slot.load(std::memory_order_seq_cst))
+				{
+					Hazards.Add(Hazard);
+				}
+			}
+		}
+		Hazards.Sort();
+
+		std::int32_t NumKept = 0;
+		for (std::int32_t Index = 0; Index < Retired.Num(); ++Index)
+		{
+			if (IsHazard(Hazards, Retired[Index].Ptr))
+			{
+				Retired[NumKept++] = Retired[Index];
+			}
+			else
+			{
+				Retired[Index].Reclaim(Retired[Index].Ptr);
+			}
+		}
+		Retired.RemoveAt(NumKept, Retired.Num() - NumKept, false);
+	}
+
+	static bool IsHazard(const TArray<void*>& SortedHazards, void* Ptr)
+	{
+		std::int32_t Low = 0;
+		std::int32_t High = SortedHazards.Num();
+		while (Low < High)
+		{
+			const std::int32_t Middle = Low + (High - Low) / 2;
+			if (SortedHazards[Middle] < Ptr)
+			{
+				Low = Middle + 1;
+			}
+			else
+			{
+				High = Middle;
+			}
+		}
+		return Low < SortedHazards.Num() && SortedHazards[Low] == Ptr;
+	}
+};
+
+/**
+ * A multi-producer, multi-consumer queue: the Michael-Scott lock-free linked queue, with hazard pointers so a
+ * dequeued node is only reused once no other thread can still be reading it. Nodes come from the same per-thread
+ * cached pool as TMpscQueue's, so steady traffic doesn't call malloc.
+ *
+ * Enqueue and Dequeue are lock-free and may be called from any number of threads.
+ */
+template <typename InElementType>
+class TMpmcQueue
+{
+public:
+	typedef InElementType ElementType;
+
+private:
+	/** The value is only constructed while the node holds one: the node at the head is always a dummy. */
+	struct FNode
+	{
+		std::atomic<FNode*> Next;
+		alignas(ElementType) unsigned char ValueStorage[sizeof(ElementType)];
+
+		ElementType* GetValue()
+		{
+			return (ElementType*)ValueStorage;
+		}
+	};
+
+	typedef typename TThreadCachedListNodeAllocator<>::template ForNodeType<FNode> NodeAllocatorType;
+
+public:
+	TMpmcQueue()
+	{
+		FNode* Dummy = AllocateNode();
+		Head.store(Dummy, std::memory_order_relaxed);
+		Tail.store(Dummy, std::memory_order_relaxed);
+	}
+
+	/** Must not run concurrently with any other use of the queue. */
+	~TMpmcQueue()
+	{
+		FNode* Node = Head.load(std::memory_order_acquire);
+		FNode* Next = Node->Next.load(std::memory_order_relaxed);
+		FreeNode(Node);
+		for (Node = Next; Node != nullptr; Node = Next)
+		{
+			Next = Node->Next.load(std::memory_order_relaxed);
+			DestructItem(Node->GetValue());
+			FreeNode(Node);
+		}
+	}
+
+	TMpmcQueue(const TMpmcQueue&) = delete;
+	TMpmcQueue& operator=(const TMpmcQueue&) = delete;
+
+	/** Adds a value at the back of the queue, constructed from Args. Thread-safe. */
+	template <typename... ArgsType>
+	void Enqueue(ArgsType&&... Args)
+	{
+		FNode* NewNode = AllocateNode();
+		new(NewNode->GetValue()) ElementType(std::forward<ArgsType>(Args)...);
+
+		for (;;)
+		{
+			FNode* Last = FHazardPointers::Protect(0, Tail);
+			FNode* Next = Last->Next.load(std::memory_order_acquire);
+			if (Next != nullptr)
+			{
+				// Tail is lagging behind; help the enqueue which got there first.
+				Tail.compare_exchange_weak(Last, Next, std::memory_order_release, std::memory_order_relaxed);
+				continue;
+			}
+
+			FNode* Expected = nullptr;
+			if (Last->Next.compare_exchange_weak(Expected, NewNode, std::memory_order_release, std::memory_order_relaxed))
+			{
+				Tail.compare_exchange_strong(Last, NewNode, std::memory_order_release, std::memory_order_relaxed);
+				break;
+			}
+		}
+		FHazardPointers::Clear(0);
+	}
+
+	/**
+	 * Moves the value at the front of the queue into OutValue. Thread-safe.
+	 *
+	 * @return false if the queue was empty.
+	 */
+	bool Dequeue(ElementType& OutValue)
+	{
+		for (;;)
+		{
+			FNode* First = FHazardPointers::Protect(0, Head);
+			FNode* Next  = First->Next.load(std::memory_order_acquire);
+
+			// Protect Next too, as its value is read after it becomes the new head. While First is still the head,
+			// Next can't have been retired yet.
+			FHazardPointers::Set(1, Next);
+			if (Head.load(std::memory_order_seq_cst) != First)
+			{
+				continue;
+			}
+
+			if (Next == nullptr)
+			{
+				FHazardPointers::Clear(0);
+				FHazardPointers::Clear(1);
+				return false;
+			}
+
+			FNode* Last = Tail.load(std::memory_order_acquire);
+			if (First == Last)
+			{
+				Tail.compare_exchange_weak(Last, Next, std::memory_order_release, std::memory_order_relaxed);
+				continue;
+			}
+
+			if (Head.compare_exchange_weak(First, Next, std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				// Next is the new dummy; its value is ours alone.
+				OutValue = MoveTempIfPossible(*Next->GetValue());
+				DestructItem(Next->GetValue());
+				FHazardPointers::Clear(0);
+				FHazardPointers::Clear(1);
+				FHazardPointers::Retire(First, &ReclaimNode);
+				return true;
+			}
+		}
+	}
+
+	/** @return true if there was nothing to dequeue at the time of the call. */
+	bool IsEmpty() const
+	{
+		FNode* First = FHazardPointers::Protect(0, Head);
+		const bool bEmpty = First->Next.load(std::memory_order_acquire) == nullptr;
+		FHazardPointers::Clear(0);
+		return bEmpty;
+	}
+
+private:
+	static FNode* AllocateNode()
+	{
+		FNode* Node = (FNode*)NodeAllocatorType().Allocate();
+		new(&Node->Next) std::atomic<FNode*>(nullptr);
+		return Node;
+	}
+
+	static void FreeNode(FNode* Node)
+	{
+		NodeAllocatorType().Free(Node);
+	}
+
+	static void ReclaimNode(void* Node)
+	{
+		FreeNode((FNode*)Node);
+	}
+
+	alignas(64) std::atomic<FNode*> Head;
+	alignas(64) std::atomic<FNode*> Tail;
+};
\ No newline at end of file
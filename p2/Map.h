@@ -0,0 +1,193 @@
+#pragma once
+#include "Pair.h"
+#include "Set.h"
+
+/** Defines how the map's pairs are hashed. */
+template <typename KeyType, typename ValueType>
+struct TDefaultMapKeyFuncs
+{
+	typedef const KeyType&                   KeyInitType;
+	typedef const TPair<KeyType, ValueType>& ElementInitType;
+
+	static const KeyType& GetSetKey(ElementInitType Element)
+	{
+		return Element.Key;
+	}
+
+	static bool Matches(const KeyType& A, const KeyType& B)
+	{
+		return A == B;
+	}
+
+	static std::uint64_t GetKeyHash(const KeyType& Key)
+	{
+		return GetTypeHash(Key);
+	}
+};
+
+/**
+ * A map of keys to values, implemented on top of TSet.
+ * The pairs are stored contiguously, so iteration visits them in a linear pass.
+ * Order and indices are not stable across removals.
+ */
+template <typename InKeyType, typename InValueType, typename KeyFuncs = TDefaultMapKeyFuncs<InKeyType, InValueType>>
+class TMap
+{
+public:
+	typedef InKeyType                        KeyType;
+	typedef InValueType                      ValueType;
+	typedef TPair<KeyType, ValueType>        ElementType;
+	typedef typename TSet<ElementType, KeyFuncs>::SizeType SizeType;
+
+	/**
+	 * Sets the value associated with a key.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @param InValue The value to associate with the key.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	ValueType& Add(const KeyType& InKey, const ValueType& InValue) { return Emplace(InKey, InValue); }
+	ValueType& Add(const KeyType& InKey, ValueType&& InValue)      { return Emplace(InKey, MoveTempIfPossible(InValue)); }
+	ValueType& Add(KeyType&& InKey, const ValueType& InValue)      { return Emplace(MoveTempIfPossible(InKey), InValue); }
+	ValueType& Add(KeyType&& InKey, ValueType&& InValue)           { return Emplace(MoveTempIfPossible(InKey), MoveTempIfPossible(InValue)); }
+
+	/**
+	 * Sets the value associated with a key, forwarding the arguments to the pair's constructor.
+	 *
+	 * @param InKey The key to associate the value with.
+	 * @param InValue The value to associate with the key.
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	template <typename InitKeyType, typename InitValueType>
+	ValueType& Emplace(InitKeyType&& InKey, InitValueType&& InValue)
+	{
+		const SizeType Index = Pairs.Emplace(ElementType(std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue)));
+		return Pairs[Index].Value;
+	}
+
+	/**
+	 * Finds the value associated with a specified key, or if none exists,
+	 * adds a value using the default constructor.
+	 *
+	 * @param Key The key to search for.
+	 * @return A reference to the value associated with the specified key.
+	 */
+	ValueType& FindOrAdd(const KeyType& Key)
+	{
+		if (ValueType* Value = Find(Key))
+		{
+			return *Value;
+		}
+		return Emplace(Key, ValueType());
+	}
+
+	/**
+	 * Removes all value associations for a key.
+	 *
+	 * @param InKey The key to remove associated values for.
+	 * @return The number of values that were associated with the key.
+	 */
+	SizeType Remove(const KeyType& InKey)
+	{
+		return Pairs.Remove(InKey);
+	}
+
+	/**
+	 * Finds the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.  The pointer
+	 *			is only valid until the next change to any key in the map.
+	 */
+	ValueType* Find(const KeyType& Key)
+	{
+		ElementType* Pair = Pairs.Find(Key);
+		return Pair ? &Pair->Value : nullptr;
+	}
+
+	const ValueType* Find(const KeyType& Key) const
+	{
+		return const_cast<TMap*>(this)->Find(Key);
+	}
+
+	/**
+	 * Finds the value associated with a specified key.
+	 *
+	 * @param Key The key to search for.
+	 * @return The value associated with the specified key, or a default constructed value if the key isn't contained in this map.
+	 */
+	ValueType FindRef(const KeyType& Key) const
+	{
+		const ValueType* Value = Find(Key);
+		return Value ? *Value : ValueType();
+	}
+
+	/**
+	 * Finds the value associated with a specified key, asserting that it exists.
+	 */
+	ValueType& FindChecked(const KeyType& Key)
+	{
+		ValueType* Value = Find(Key);
+		_ASSERT(Value != nullptr);
+		return *Value;
+	}
+
+	const ValueType& FindChecked(const KeyType& Key) const
+	{
+		return const_cast<TMap*>(this)->FindChecked(Key);
+	}
+
+	ValueType&       operator[](const KeyType& Key)       { return FindChecked(Key); }
+	const ValueType& operator[](const KeyType& Key) const { return FindChecked(Key); }
+
+	bool Contains(const KeyType& Key) const
+	{
+		return Pairs.Contains(Key);
+	}
+
+	/** Preallocates enough memory to contain Number pairs without reallocating or rehashing. */
+	void Reserve(SizeType Number)
+	{
+		Pairs.Reserve(Number);
+	}
+
+	/**
+	 * Removes all elements from the map.
+	 *
+	 * @param ExpectedNumElements The number of elements about to be added to the map.
+	 */
+	void Empty(SizeType ExpectedNumElements = 0)
+	{
+		Pairs.Empty(ExpectedNumElements);
+	}
+
+	/** Efficiently empties out the map but preserves all allocations and capacities */
+	void Reset()
+	{
+		Pairs.Reset();
+	}
+
+	SizeType Num() const
+	{
+		return Pairs.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Pairs.IsEmpty();
+	}
+
+	/** @return the densely packed key/value pairs of the map. */
+	const TArray<ElementType>& Array() const
+	{
+		return Pairs.Array();
+	}
+
+private:
+	TSet<ElementType, KeyFuncs> Pairs;
+
+	friend       ElementType* begin(      TMap& Map) { return begin(Map.Pairs); }
+	friend const ElementType* begin(const TMap& Map) { return begin(Map.Pairs); }
+	friend       ElementType* end  (      TMap& Map) { return end  (Map.Pairs); }
+	friend const ElementType* end  (const TMap& Map) { return end  (Map.Pairs); }
+};
\ No newline at end of file
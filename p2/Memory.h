@@ -0,0 +1,714 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <typeinfo>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+/**
+ * The memory layer container storage is allocated through: ResizeAllocation in Util.h for element buffers and pools,
+ * FMemory::MallocAligned for over-aligned buffers, and class-level operator new/delete for separately allocated nodes.
+ *
+ * One exception: FDefaultListNodeAllocator gives each TDoubleLinkedList node its own global operator new, as the list
+ * always did, because the block header below would double the size of a small node. Lists which use one of the pooled
+ * node allocators (ListNodeAllocator.h) are tracked.
+ *
+ * Allocation is delegated to a pluggable IMemoryBackend: plain malloc, a thread-caching small-block allocator, or an arena.
+ * Every block carries a small header recording its size, the backend which allocated it and the tags it is charged to, so
+ * blocks can be freed after the backend is switched and live bytes are exact.
+ *
+ * With MEMORY_TRACKING enabled, each block is charged to:
+ *		- the type tag of the container which allocated it, e.g. TArray<FVector>;
+ *		- the innermost MEMORY_SCOPE active on the allocating thread, if any, which identifies the call site;
+ *		- the global total.
+ * Each tag counts live bytes, peak live bytes, allocations, reallocations, frees and the bytes copied when a reallocation
+ * had to move the block, which is what finds containers that churn. FMemory::DumpReport prints them.
+ *
+ * Usage:
+ *		{
+ *			MEMORY_SCOPE("LoadConfig");
+ *			TArray<FEntry> Entries = ParseEntries(File);	// charged to "LoadConfig" and to TArray<FEntry>
+ *		}
+ *		FMemory::DumpReport();
+ */
+#ifndef MEMORY_TRACKING
+	#define MEMORY_TRACKING 1
+#endif
+
+/** A set of allocation counters. Tags register themselves on construction and must have static storage duration. */
+class FMemoryTag
+{
+public:
+	enum class EKind
+	{
+		Total,
+		Type,
+		Scope,
+	};
+
+	FMemoryTag(const char* InName, EKind InKind, const char* InFile = nullptr, int InLine = 0)
+		: Name(InName)
+		, File(InFile)
+		, Line(InLine)
+		, Kind(InKind)
+		, LiveBytes(0)
+		, PeakLiveBytes(0)
+		, NumAllocs(0)
+		, NumReallocs(0)
+		, NumFrees(0)
+		, BytesCopied(0)
+		, Next(nullptr)
+	{
+		// Lock-free push onto the list of all tags; tags are never unregistered.
+		FMemoryTag* Head = GetListHead().load(std::memory_order_relaxed);
+		do
+		{
+			Next = Head;
+		}
+		while (!GetListHead().compare_exchange_weak(Head, this, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	FMemoryTag(const FMemoryTag&) = delete;
+	FMemoryTag& operator=(const FMemoryTag&) = delete;
+
+	void OnAlloc(std::size_t Size)
+	{
+		NumAllocs.fetch_add(1, std::memory_order_relaxed);
+		AddLiveBytes((std::int64_t)Size);
+	}
+
+	void OnRealloc(std::size_t OldSize, std::size_t NewSize, bool bMoved)
+	{
+		NumReallocs.fetch_add(1, std::memory_order_relaxed);
+		if (bMoved)
+		{
+			BytesCopied.fetch_add(OldSize < NewSize ? OldSize : NewSize, std::memory_order_relaxed);
+		}
+		AddLiveBytes((std::int64_t)NewSize - (std::int64_t)OldSize);
+	}
+
+	void OnFree(std::size_t Size)
+	{
+		NumFrees.fetch_add(1, std::memory_order_relaxed);
+		AddLiveBytes(-(std::int64_t)Size);
+	}
+
+	const char* GetName() const
+	{
+		return Name;
+	}
+
+	EKind GetKind() const
+	{
+		return Kind;
+	}
+
+	std::int64_t  GetLiveBytes()     const { return LiveBytes.load(std::memory_order_relaxed); }
+	std::int64_t  GetPeakLiveBytes() const { return PeakLiveBytes.load(std::memory_order_relaxed); }
+	std::uint64_t GetNumAllocs()     const { return NumAllocs.load(std::memory_order_relaxed); }
+	std::uint64_t GetNumReallocs()   const { return NumReallocs.load(std::memory_order_relaxed); }
+	std::uint64_t GetNumFrees()      const { return NumFrees.load(std::memory_order_relaxed); }
+	std::uint64_t GetBytesCopied()   const { return BytesCopied.load(std::memory_order_relaxed); }
+
+	/** Calls Func(const FMemoryTag&) for every tag, most recently registered first. */
+	template <typename FuncType>
+	static void ForEachTag(FuncType&& Func)
+	{
+		for (const FMemoryTag* Tag = GetListHead().load(std::memory_order_acquire); Tag; Tag = Tag->Next)
+		{
+			Func(*Tag);
+		}
+	}
+
+	/** Writes the counters of one tag as a report line. */
+	void Print(std::FILE* Out) const
+	{
+		char DemangledBuffer[256];
+		const char* DisplayName = GetDisplayName(DemangledBuffer, sizeof(DemangledBuffer));
+		std::fprintf(Out, "  %-48s live %12lld  peak %12lld  allocs %8llu  reallocs %8llu  frees %8llu  copied %12llu",
+			DisplayName,
+			(long long)GetLiveBytes(), (long long)GetPeakLiveBytes(),
+			(unsigned long long)GetNumAllocs(), (unsigned long long)GetNumReallocs(),
+			(unsigned long long)GetNumFrees(), (unsigned long long)GetBytesCopied());
+		if (File)
+		{
+			std::fprintf(Out, "  (%s:%d)", File, Line);
+		}
+		std::fprintf(Out, "\n");
+	}
+
+private:
+	void AddLiveBytes(std::int64_t Delta)
+	{
+		const std::int64_t NewLive = LiveBytes.fetch_add(Delta, std::memory_order_relaxed) + Delta;
+		std::int64_t Peak = PeakLiveBytes.load(std::memory_order_relaxed);
+		while (NewLive > Peak && !PeakLiveBytes.compare_exchange_weak(Peak, NewLive, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	/** Type tags are named with typeid, which is mangled on gcc and clang. */
+	const char* GetDisplayName(char* Buffer, std::size_t BufferSize) const
+	{
+#if defined(__GNUG__)
+		if (Kind == EKind::Type)
+		{
+			int Status = 0;
+			char* Demangled = abi::__cxa_demangle(Name, nullptr, nullptr, &Status);
+			if (Status == 0 && Demangled)
+			{
+				std::snprintf(Buffer, BufferSize, "%s", Demangled);
+				std::free(Demangled);
+				return Buffer;
+			}
+		}
+#endif
+		return Name;
+	}
+
+	static std::atomic<FMemoryTag*>& GetListHead()
+	{
+		static std::atomic<FMemoryTag*> Head{ nullptr };
+		return Head;
+	}
+
+	const char*                Name;
+	const char*                File;
+	int                        Line;
+	EKind                      Kind;
+	std::atomic<std::int64_t>  LiveBytes;
+	std::atomic<std::int64_t>  PeakLiveBytes;
+	std::atomic<std::uint64_t> NumAllocs;
+	std::atomic<std::uint64_t> NumReallocs;
+	std::atomic<std::uint64_t> NumFrees;
+	std::atomic<std::uint64_t> BytesCopied;
+	FMemoryTag*                Next;
+};
+
+/** @return the tag charged with allocations made by containers of type T. */
+template <typename T>
+FMemoryTag& GetMemoryTypeTag()
+{
+	static FMemoryTag Tag(typeid(T).name(), FMemoryTag::EKind::Type);
+	return Tag;
+}
+
+/**
+ * Where memory comes from. Backends see raw blocks only; the memory layer adds the block header and the accounting.
+ * Backends are never destroyed through this interface and must outlive every block they hand out.
+ */
+class IMemoryBackend
+{
+public:
+	virtual void* Malloc(std::size_t Size) = 0;
+
+	/** @return a block of NewSize bytes holding the first min(OldSize, NewSize) bytes of Ptr; Ptr is released if the block moved. */
+	virtual void* Realloc(void* Ptr, std::size_t OldSize, std::size_t NewSize) = 0;
+
+	virtual void Free(void* Ptr, std::size_t Size) = 0;
+
+	virtual const char* GetName() const = 0;
+
+protected:
+	~IMemoryBackend() = default;
+};
+
+/** The C runtime heap. */
+class FMallocMemoryBackend final : public IMemoryBackend
+{
+public:
+	virtual void* Malloc(std::size_t Size) override
+	{
+		return std::malloc(Size);
+	}
+
+	virtual void* Realloc(void* Ptr, std::size_t, std::size_t NewSize) override
+	{
+		return std::realloc(Ptr, NewSize);
+	}
+
+	virtual void Free(void* Ptr, std::size_t) override
+	{
+		std::free(Ptr);
+	}
+
+	virtual const char* GetName() const override
+	{
+		return "Malloc";
+	}
+};
+
+/**
+ * Keeps small freed blocks in per-thread, per-size-class free lists and hands them back out without touching the heap
+ * or any lock. Blocks bigger than MaxSmallSize go straight to malloc. A block freed on another thread simply joins
+ * that thread's cache. Each list holds at most MaxCachedPerClass blocks; the rest go back to the heap.
+ */
+class FThreadCachingMemoryBackend final : public IMemoryBackend
+{
+public:
+	static constexpr std::size_t MinSmallSizeLog2  = 4;	// 16 bytes
+	static constexpr std::size_t MaxSmallSizeLog2  = 10;	// 1024 bytes
+	static constexpr std::size_t MaxSmallSize      = std::size_t(1) << MaxSmallSizeLog2;
+	static constexpr std::size_t NumSizeClasses    = MaxSmallSizeLog2 - MinSmallSizeLog2 + 1;
+	static constexpr std::uint32_t MaxCachedPerClass = 256;
+
+	virtual void* Malloc(std::size_t Size) override
+	{
+		if (Size > MaxSmallSize)
+		{
+			return std::malloc(Size);
+		}
+
+		const std::size_t SizeClass = GetSizeClass(Size);
+		FThreadCache& Cache = GetThreadCache();
+		if (FFreeBlock* Block = Cache.FreeLists[SizeClass])
+		{
+			Cache.FreeLists[SizeClass] = Block->Next;
+			--Cache.NumCached[SizeClass];
+			return Block;
+		}
+		return std::malloc(GetClassSize(SizeClass));
+	}
+
+	virtual void* Realloc(void* Ptr, std::size_t OldSize, std::size_t NewSize) override
+	{
+		if (OldSize > MaxSmallSize && NewSize > MaxSmallSize)
+		{
+			return std::realloc(Ptr, NewSize);
+		}
+		if (OldSize <= MaxSmallSize && NewSize <= MaxSmallSize && GetSizeClass(OldSize) == GetSizeClass(NewSize))
+		{
+			return Ptr;
+		}
+
+		void* NewPtr = Malloc(NewSize);
+		if (NewPtr)
+		{
+			std::memcpy(NewPtr, Ptr, OldSize < NewSize ? OldSize : NewSize);
+			Free(Ptr, OldSize);
+		}
+		return NewPtr;
+	}
+
+	virtual void Free(void* Ptr, std::size_t Size) override
+	{
+		if (Size > MaxSmallSize)
+		{
+			std::free(Ptr);
+			return;
+		}
+
+		const std::size_t SizeClass = GetSizeClass(Size);
+		FThreadCache& Cache = GetThreadCache();
+		if (Cache.NumCached[SizeClass] >= MaxCachedPerClass)
+		{
+			std::free(Ptr);
+			return;
+		}
+
+		FFreeBlock* Block = (FFreeBlock*)Ptr;
+		Block->Next = Cache.FreeLists[SizeClass];
+		Cache.FreeLists[SizeClass] = Block;
+		++Cache.NumCached[SizeClass];
+	}
+
+	virtual const char* GetName() const override
+	{
+		return "ThreadCaching";
+	}
+
+private:
+	struct FFreeBlock
+	{
+		FFreeBlock* Next;
+	};
+
+	struct FThreadCache
+	{
+		FThreadCache()
+		{
+			for (std::size_t SizeClass = 0; SizeClass < NumSizeClasses; ++SizeClass)
+			{
+				FreeLists[SizeClass] = nullptr;
+				NumCached[SizeClass] = 0;
+			}
+		}
+
+		~FThreadCache()
+		{
+			for (FFreeBlock* List : FreeLists)
+			{
+				while (List)
+				{
+					FFreeBlock* Next = List->Next;
+					std::free(List);
+					List = Next;
+				}
+			}
+		}
+
+		FFreeBlock*   FreeLists[NumSizeClasses];
+		std::uint32_t NumCached[NumSizeClasses];
+	};
+
+	static std::size_t GetSizeClass(std::size_t Size)
+	{
+		std::size_t SizeClass = 0;
+		while ((std::size_t(1) << (SizeClass + MinSmallSizeLog2)) < Size)
+		{
+			++SizeClass;
+		}
+		return SizeClass;
+	}
+
+	static std::size_t GetClassSize(std::size_t SizeClass)
+	{
+		return std::size_t(1) << (SizeClass + MinSmallSizeLog2);
+	}
+
+	static FThreadCache& GetThreadCache()
+	{
+		static thread_local FThreadCache Cache;
+		return Cache;
+	}
+};
+
+/**
+ * Bump allocator over large pages: allocation is a pointer increment, and everything is released at once by Reset().
+ * Freeing or growing the most recent block works in place; other frees leave a hole until Reset().
+ * Only use it for phases whose containers are all destroyed before Reset().
+ */
+class FArenaMemoryBackend final : public IMemoryBackend
+{
+public:
+	explicit FArenaMemoryBackend(std::size_t InPageSize = 1024 * 1024)
+		: PageSize(InPageSize)
+		, CurrentPage(nullptr)
+		, Cursor(nullptr)
+		, PageEnd(nullptr)
+		, LastBlock(nullptr)
+	{ }
+
+	FArenaMemoryBackend(const FArenaMemoryBackend&) = delete;
+	FArenaMemoryBackend& operator=(const FArenaMemoryBackend&) = delete;
+
+	~FArenaMemoryBackend()
+	{
+		Reset();
+	}
+
+	virtual void* Malloc(std::size_t Size) override
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return AllocateLocked(Size);
+	}
+
+	virtual void* Realloc(void* Ptr, std::size_t OldSize, std::size_t NewSize) override
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (Ptr == LastBlock && (std::uint8_t*)Ptr + AlignSize(NewSize) <= PageEnd)
+		{
+			Cursor = (std::uint8_t*)Ptr + AlignSize(NewSize);
+			return Ptr;
+		}
+
+		void* NewPtr = AllocateLocked(NewSize);
+		if (NewPtr)
+		{
+			std::memcpy(NewPtr, Ptr, OldSize < NewSize ? OldSize : NewSize);
+		}
+		return NewPtr;
+	}
+
+	virtual void Free(void* Ptr, std::size_t) override
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (Ptr == LastBlock)
+		{
+			Cursor = (std::uint8_t*)Ptr;
+			LastBlock = nullptr;
+		}
+	}
+
+	virtual const char* GetName() const override
+	{
+		return "Arena";
+	}
+
+	/** Releases every page. Every block handed out by the arena becomes invalid. */
+	void Reset()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		while (CurrentPage)
+		{
+			FPage* Previous = CurrentPage->Previous;
+			std::free(CurrentPage);
+			CurrentPage = Previous;
+		}
+		Cursor = PageEnd = nullptr;
+		LastBlock = nullptr;
+	}
+
+private:
+	struct alignas(16) FPage
+	{
+		FPage* Previous;
+	};
+
+	static std::size_t AlignSize(std::size_t Size)
+	{
+		return (Size + 15) & ~std::size_t(15);
+	}
+
+	void* AllocateLocked(std::size_t Size)
+	{
+		Size = AlignSize(Size);
+		if (!Cursor || Cursor + Size > PageEnd)
+		{
+			// Oversized blocks get a page of their own.
+			const std::size_t NewPageSize = Size > PageSize ? Size : PageSize;
+			FPage* Page = (FPage*)std::malloc(sizeof(FPage) + NewPageSize);
+			if (!Page)
+			{
+				return nullptr;
+			}
+			Page->Previous = CurrentPage;
+			CurrentPage = Page;
+			Cursor = (std::uint8_t*)(Page + 1);
+			PageEnd = Cursor + NewPageSize;
+		}
+
+		LastBlock = Cursor;
+		Cursor += Size;
+		return LastBlock;
+	}
+
+	std::mutex    Mutex;
+	std::size_t   PageSize;
+	FPage*        CurrentPage;
+	std::uint8_t* Cursor;
+	std::uint8_t* PageEnd;
+	void*         LastBlock;
+};
+
+/** Marks an allocation call site: allocations on this thread until the end of the enclosing scope are charged to it. */
+class FMemoryScope
+{
+public:
+	explicit FMemoryScope(FMemoryTag& Tag)
+		: PreviousTag(GetCurrentTag())
+	{
+		GetCurrentTag() = &Tag;
+	}
+
+	~FMemoryScope()
+	{
+		GetCurrentTag() = PreviousTag;
+	}
+
+	FMemoryScope(const FMemoryScope&) = delete;
+	FMemoryScope& operator=(const FMemoryScope&) = delete;
+
+	static FMemoryTag*& GetCurrentTag()
+	{
+		static thread_local FMemoryTag* CurrentTag = nullptr;
+		return CurrentTag;
+	}
+
+private:
+	FMemoryTag* PreviousTag;
+};
+
+#define MEMORY_SCOPE_CONCAT_INNER(A, B) A##B
+#define MEMORY_SCOPE_CONCAT(A, B) MEMORY_SCOPE_CONCAT_INNER(A, B)
+
+#if MEMORY_TRACKING
+	#define MEMORY_SCOPE(Name) \
+		static FMemoryTag MEMORY_SCOPE_CONCAT(MemoryScopeTag_, __LINE__)(Name, FMemoryTag::EKind::Scope, __FILE__, __LINE__); \
+		FMemoryScope MEMORY_SCOPE_CONCAT(MemoryScope_, __LINE__)(MEMORY_SCOPE_CONCAT(MemoryScopeTag_, __LINE__))
+#else
+	#define MEMORY_SCOPE(Name)
+#endif
+
+/** Entry points of the memory layer. */
+struct FMemory
+{
+	/**
+	 * Allocates, resizes or frees a block, like realloc: a null Ptr allocates, a zero NewSize frees.
+	 *
+	 * @param TypeTag Tag of the container type making the call, or nullptr.
+	 * @return the new block, or nullptr if it was freed or allocation failed.
+	 */
+	static void* Realloc(void* Ptr, std::size_t NewSize, FMemoryTag* TypeTag = nullptr)
+	{
+		if (!NewSize)
+		{
+			Free(Ptr);
+			return nullptr;
+		}
+
+		if (!Ptr)
+		{
+			IMemoryBackend* Backend = GetBackend();
+			FBlockHeader* Header = (FBlockHeader*)Backend->Malloc(sizeof(FBlockHeader) + NewSize);
+			if (!Header)
+			{
+				return nullptr;
+			}
+			Header->Size = NewSize;
+			Header->Backend = Backend;
+			Header->TypeTag = TypeTag;
+			Header->ScopeTag = FMemoryScope::GetCurrentTag();
+#if MEMORY_TRACKING
+			ForEachTagOf(Header, [NewSize](FMemoryTag& Tag) { Tag.OnAlloc(NewSize); });
+#endif
+			return Header + 1;
+		}
+
+		FBlockHeader* OldHeader = (FBlockHeader*)Ptr - 1;
+		const std::size_t OldSize = OldHeader->Size;
+		FBlockHeader* NewHeader = (FBlockHeader*)OldHeader->Backend->Realloc(OldHeader, sizeof(FBlockHeader) + OldSize, sizeof(FBlockHeader) + NewSize);
+		if (!NewHeader)
+		{
+			return nullptr;
+		}
+		NewHeader->Size = NewSize;
+#if MEMORY_TRACKING
+		const bool bMoved = NewHeader != OldHeader;
+		ForEachTagOf(NewHeader, [OldSize, NewSize, bMoved](FMemoryTag& Tag) { Tag.OnRealloc(OldSize, NewSize, bMoved); });
+#endif
+		return NewHeader + 1;
+	}
+
+	static void Free(void* Ptr)
+	{
+		if (!Ptr)
+		{
+			return;
+		}
+
+		FBlockHeader* Header = (FBlockHeader*)Ptr - 1;
+		const std::size_t Size = Header->Size;
+#if MEMORY_TRACKING
+		ForEachTagOf(Header, [Size](FMemoryTag& Tag) { Tag.OnFree(Size); });
+#endif
+		Header->Backend->Free(Header, sizeof(FBlockHeader) + Size);
+	}
+
+	/**
+	 * Allocates Size bytes aligned to Alignment, a power of two, charged to TypeTag like Realloc. The block is over-allocated
+	 * by Alignment bytes, which are charged too. Free it with FreeAligned.
+	 */
+	static void* MallocAligned(std::size_t Size, std::size_t Alignment, FMemoryTag* TypeTag = nullptr)
+	{
+		Alignment = Alignment > alignof(FBlockHeader) ? Alignment : alignof(FBlockHeader);
+		void* Block = Realloc(nullptr, Size + Alignment, TypeTag);
+		if (!Block)
+		{
+			return nullptr;
+		}
+
+		// Blocks are already aligned to alignof(FBlockHeader), so this leaves room for the pointer to the block.
+		void** Aligned = (void**)(((std::uintptr_t)Block + Alignment) & ~(std::uintptr_t)(Alignment - 1));
+		Aligned[-1] = Block;
+		return Aligned;
+	}
+
+	static void FreeAligned(void* Ptr)
+	{
+		if (Ptr)
+		{
+			Free(((void**)Ptr)[-1]);
+		}
+	}
+
+	/** @return the size requested for a block returned by Realloc. */
+	static std::size_t GetAllocSize(const void* Ptr)
+	{
+		return Ptr ? ((const FBlockHeader*)Ptr - 1)->Size : 0;
+	}
+
+	static IMemoryBackend* GetBackend()
+	{
+		return GetBackendRef().load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Makes new allocations come from Backend. Existing blocks are still freed by the backend which allocated them,
+	 * so it is safe to switch at any time, as long as every backend outlives its blocks.
+	 */
+	static void SetBackend(IMemoryBackend* Backend)
+	{
+		GetBackendRef().store(Backend ? Backend : &GetMallocBackend(), std::memory_order_release);
+	}
+
+	static FMallocMemoryBackend& GetMallocBackend()
+	{
+		static FMallocMemoryBackend Backend;
+		return Backend;
+	}
+
+	/** @return the tag charged with every allocation. */
+	static FMemoryTag& GetTotalTag()
+	{
+		static FMemoryTag Tag("Total", FMemoryTag::EKind::Total);
+		return Tag;
+	}
+
+	/** Prints the counters of every tag that has seen an allocation. */
+	static void DumpReport(std::FILE* Out = stdout)
+	{
+		std::fprintf(Out, "Memory report (backend: %s)\n", GetBackend()->GetName());
+		GetTotalTag().Print(Out);
+
+		const char* const SectionNames[] = { "By container type:", "By scope:" };
+		const FMemoryTag::EKind SectionKinds[] = { FMemoryTag::EKind::Type, FMemoryTag::EKind::Scope };
+		for (int Section = 0; Section < 2; ++Section)
+		{
+			std::fprintf(Out, "%s\n", SectionNames[Section]);
+			FMemoryTag::ForEachTag([Out, Kind = SectionKinds[Section]](const FMemoryTag& Tag)
+			{
+				if (Tag.GetKind() == Kind && Tag.GetNumAllocs())
+				{
+					Tag.Print(Out);
+				}
+			});
+		}
+	}
+
+private:
+	/** Precedes every block. 32 bytes, so blocks keep the 16-byte alignment of the backend. */
+	struct alignas(16) FBlockHeader
+	{
+		std::size_t     Size;
+		IMemoryBackend* Backend;
+		FMemoryTag*     TypeTag;
+		FMemoryTag*     ScopeTag;
+	};
+	static_assert(sizeof(FBlockHeader) % 16 == 0, "Block header must preserve alignment");
+
+	template <typename FuncType>
+	static void ForEachTagOf(FBlockHeader* Header, const FuncType& Func)
+	{
+		Func(GetTotalTag());
+		if (Header->TypeTag)
+		{
+			Func(*Header->TypeTag);
+		}
+		if (Header->ScopeTag)
+		{
+			Func(*Header->ScopeTag);
+		}
+	}
+
+	static std::atomic<IMemoryBackend*>& GetBackendRef()
+	{
+		static std::atomic<IMemoryBackend*> Backend{ &GetMallocBackend() };
+		return Backend;
+	}
+};
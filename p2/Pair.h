@@ -0,0 +1,20 @@
+#pragma once
+#include <utility>
+
+/**
+ * A key/value pair, as stored by TMap and TFlatMap.
+ */
+template <typename KeyType, typename ValueType>
+struct TPair
+{
+	TPair() = default;
+
+	template <typename KeyArgType, typename ValueArgType>
+	TPair(KeyArgType&& InKey, ValueArgType&& InValue)
+		: Key(std::forward<KeyArgType>(InKey))
+		, Value(std::forward<ValueArgType>(InValue))
+	{ }
+
+	KeyType   Key;
+	ValueType Value;
+};
\ No newline at end of file
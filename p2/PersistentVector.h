@@ -0,0 +1,650 @@
+#pragma once
+#include <atomic>
+#include "Array.h"
+
+/**
+ * An immutable vector with structural sharing, for keeping many versions of an array alive at once.
+ *
+ * The elements live in the leaves of a 32-way trie, plus a tail leaf holding the last 1-32 elements. Set and Push
+ * return a new version which copies only the O(log32 N) nodes on the path to the change and shares every other node
+ * with the old version, so each version costs memory proportional to the change, not to the array. Pushes mostly
+ * touch just the tail. Nodes are reference counted atomically, so versions may be shared between threads.
+ *
+ * Bulk building should go through an FTransient: nodes it creates belong to it and are edited in place, so a batch
+ * of pushes or sets does not copy a path per element. Persistent() turns the transient back into a vector in O(1).
+ *
+ * Usage:
+ *		TPersistentVector<int> V0;
+ *		TPersistentVector<int> V1 = V0.Push(1);
+ *		TPersistentVector<int> V2 = V1.Set(0, 2);		// V1[0] is still 1
+ *
+ *		TPersistentVector<int>::FTransient Builder = V2.Transient();
+ *		for (int i = 0; i < 1000; i++) { Builder.Push(i); }
+ *		TPersistentVector<int> V3 = Builder.Persistent();
+ */
+template <typename InElementType>
+class TPersistentVector
+{
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	static constexpr std::uint32_t BranchBits   = 5;
+	static constexpr std::uint32_t BranchFactor = 1 << BranchBits;
+	static constexpr std::uint32_t BranchMask   = BranchFactor - 1;
+
+private:
+	/** Nodes created by a transient carry its owner id, and only that transient may edit them in place. Persistent nodes have Owner 0. */
+	typedef std::uint64_t FOwnerId;
+
+	struct FNode
+	{
+		explicit FNode(FOwnerId InOwner)
+			: RefCount(1)
+			, Owner(InOwner)
+		{ }
+
+		/** Nodes are allocated through the memory layer, charged to the vector type. */
+		static void* operator new(std::size_t Size)
+		{
+			static_assert(alignof(ElementType) <= 16, "Elements aligned beyond 16 bytes are not supported");
+			return FMemory::Realloc(nullptr, Size, &GetMemoryTypeTag<TPersistentVector>());
+		}
+
+		static void operator delete(void* Ptr)
+		{
+			FMemory::Free(Ptr);
+		}
+
+		std::atomic<std::int32_t> RefCount;
+		FOwnerId                  Owner;
+	};
+
+	struct FInnerNode : FNode
+	{
+		explicit FInnerNode(FOwnerId InOwner)
+			: FNode(InOwner)
+		{
+			for (FNode*& Child : Children)
+			{
+				Child = nullptr;
+			}
+		}
+
+		FNode* Children[BranchFactor];
+	};
+
+	struct FLeafNode : FNode
+	{
+		explicit FLeafNode(FOwnerId InOwner)
+			: FNode(InOwner)
+			, Num(0)
+		{ }
+
+		~FLeafNode()
+		{
+			DestructItems(GetData(), Num);
+		}
+
+		ElementType* GetData()
+		{
+			return (ElementType*)Storage;
+		}
+
+		std::uint32_t Num;
+		alignas(ElementType) unsigned char Storage[BranchFactor * sizeof(ElementType)];
+	};
+
+	/**
+	 * The root, tail and shape of one version. The state holds one reference to its root and tail.
+	 *
+	 * Every edit takes the reference held by a slot (a state member or a parent's child pointer), and puts back a
+	 * reference to the node which replaces it: either the same node, edited in place, or a copy, in which case the
+	 * reference to the original is released.
+	 */
+	struct FState
+	{
+		FState()
+			: Root(nullptr)
+			, Tail(nullptr)
+			, Count(0)
+			, Shift(BranchBits)
+		{ }
+
+		/** @return the index of the first element stored in the tail. */
+		SizeType GetTailOffset() const
+		{
+			return Count < (SizeType)BranchFactor ? 0 : ((Count - 1) >> BranchBits) << BranchBits;
+		}
+
+		/** @return the leaf which holds the element at Index. */
+		FLeafNode* GetLeaf(SizeType Index) const
+		{
+			_ASSERT(Index >= 0 && Index < Count);
+			if (Index >= GetTailOffset())
+			{
+				return Tail;
+			}
+
+			FNode* Node = Root;
+			for (std::uint32_t Level = Shift; Level > 0; Level -= BranchBits)
+			{
+				Node = ((FInnerNode*)Node)->Children[(Index >> Level) & BranchMask];
+			}
+			return (FLeafNode*)Node;
+		}
+
+		void AddRefAll() const
+		{
+			AddRef(Root);
+			AddRef(Tail);
+		}
+
+		void ReleaseAll()
+		{
+			Release(Root, Shift);
+			Release(Tail, 0);
+			*this = FState();
+		}
+
+		template <typename ArgType>
+		void Push(ArgType&& Value, FOwnerId Owner)
+		{
+			if (Count - GetTailOffset() < (SizeType)BranchFactor)
+			{
+				Tail = Tail ? MakeEditable(Tail, Owner) : new FLeafNode(Owner);
+			}
+			else
+			{
+				// The tail is full: it moves into the trie, and a new tail is started.
+				if (std::uint32_t(Count >> BranchBits) > (1u << Shift))
+				{
+					// The trie is full too, so it grows a new root.
+					FInnerNode* NewRoot = new FInnerNode(Owner);
+					NewRoot->Children[0] = Root;
+					NewRoot->Children[1] = NewPath(Shift, Tail, Owner);
+					Root = NewRoot;
+					Shift += BranchBits;
+				}
+				else
+				{
+					Root = PushTail(Shift, Root, Tail, Owner);
+				}
+				Tail = new FLeafNode(Owner);
+			}
+
+			new(Tail->GetData() + Tail->Num) ElementType(std::forward<ArgType>(Value));
+			++Tail->Num;
+			++Count;
+		}
+
+		template <typename ArgType>
+		void Set(SizeType Index, ArgType&& Value, FOwnerId Owner)
+		{
+			_ASSERT(Index >= 0 && Index < Count);
+			if (Index >= GetTailOffset())
+			{
+				Tail = MakeEditable(Tail, Owner);
+				Tail->GetData()[Index & BranchMask] = std::forward<ArgType>(Value);
+			}
+			else
+			{
+				Root = (FInnerNode*)SetInTrie(Shift, Root, Index, std::forward<ArgType>(Value), Owner);
+			}
+		}
+
+		void Pop(FOwnerId Owner)
+		{
+			_ASSERT(Count > 0);
+			if (Count == 1)
+			{
+				ReleaseAll();
+				return;
+			}
+
+			if (Count - GetTailOffset() > 1)
+			{
+				Tail = MakeEditable(Tail, Owner);
+				--Tail->Num;
+				DestructItem(Tail->GetData() + Tail->Num);
+			}
+			else
+			{
+				// The tail is about to be empty: the last leaf of the trie becomes the tail.
+				FLeafNode* NewTail = GetLeaf(Count - 2);
+				AddRef(NewTail);
+				Release(Tail, 0);
+				Tail = NewTail;
+
+				Root = PopTail(Shift, Root, Owner);
+				if (Root && Shift > BranchBits && !Root->Children[1])
+				{
+					FInnerNode* OnlyChild = (FInnerNode*)Root->Children[0];
+					AddRef(OnlyChild);
+					Release(Root, Shift);
+					Root = OnlyChild;
+					Shift -= BranchBits;
+				}
+			}
+			--Count;
+		}
+
+		FInnerNode*   Root;
+		FLeafNode*    Tail;
+		SizeType      Count;
+		std::uint32_t Shift;
+
+	private:
+		/** Appends a full tail leaf to the trie below Parent, which is at Level. */
+		FInnerNode* PushTail(std::uint32_t Level, FInnerNode* Parent, FLeafNode* TailLeaf, FOwnerId Owner) const
+		{
+			FInnerNode* Result = Parent ? MakeEditable(Parent, Level, Owner) : new FInnerNode(Owner);
+			const std::uint32_t SubIndex = ((Count - 1) >> Level) & BranchMask;
+			FNode*& Child = Result->Children[SubIndex];
+			if (Level == BranchBits)
+			{
+				Child = TailLeaf;
+			}
+			else
+			{
+				Child = Child ? PushTail(Level - BranchBits, (FInnerNode*)Child, TailLeaf, Owner) : NewPath(Level - BranchBits, TailLeaf, Owner);
+			}
+			return Result;
+		}
+
+		/** Removes the last leaf of the trie below Node, which is at Level. @return nullptr if the node is left empty. */
+		FInnerNode* PopTail(std::uint32_t Level, FInnerNode* Node, FOwnerId Owner) const
+		{
+			FInnerNode* Result = MakeEditable(Node, Level, Owner);
+			const std::uint32_t SubIndex = ((Count - 2) >> Level) & BranchMask;
+			FNode*& Child = Result->Children[SubIndex];
+			if (Level > BranchBits)
+			{
+				Child = PopTail(Level - BranchBits, (FInnerNode*)Child, Owner);
+			}
+			else
+			{
+				Release(Child, 0);
+				Child = nullptr;
+			}
+
+			// SubIndex is the last used child, so if the first child is gone, the node is empty.
+			if (!Result->Children[0])
+			{
+				Release(Result, Level);
+				return nullptr;
+			}
+			return Result;
+		}
+
+		template <typename ArgType>
+		static FNode* SetInTrie(std::uint32_t Level, FNode* Node, SizeType Index, ArgType&& Value, FOwnerId Owner)
+		{
+			if (Level == 0)
+			{
+				FLeafNode* Leaf = MakeEditable((FLeafNode*)Node, Owner);
+				Leaf->GetData()[Index & BranchMask] = std::forward<ArgType>(Value);
+				return Leaf;
+			}
+
+			FInnerNode* Inner = MakeEditable((FInnerNode*)Node, Level, Owner);
+			FNode*& Child = Inner->Children[(Index >> Level) & BranchMask];
+			Child = SetInTrie(Level - BranchBits, Child, Index, std::forward<ArgType>(Value), Owner);
+			return Inner;
+		}
+
+		/** @return a chain of new inner nodes from Level down to Leaf. */
+		static FNode* NewPath(std::uint32_t Level, FLeafNode* Leaf, FOwnerId Owner)
+		{
+			if (Level == 0)
+			{
+				return Leaf;
+			}
+
+			FInnerNode* Node = new FInnerNode(Owner);
+			Node->Children[0] = NewPath(Level - BranchBits, Leaf, Owner);
+			return Node;
+		}
+	};
+
+public:
+	/** A mutable view of a version which edits its own nodes in place. See the class comment. */
+	class FTransient
+	{
+	public:
+		FTransient(FTransient&& Other)
+			: State(Other.State)
+			, Owner(Other.Owner)
+		{
+			Other.State = FState();
+		}
+
+		~FTransient()
+		{
+			State.ReleaseAll();
+		}
+
+		FTransient(const FTransient&) = delete;
+		FTransient& operator=(const FTransient&) = delete;
+
+		void Push(const ElementType& Value)
+		{
+			State.Push(Value, Owner);
+		}
+
+		void Push(ElementType&& Value)
+		{
+			State.Push(MoveTempIfPossible(Value), Owner);
+		}
+
+		void Set(SizeType Index, const ElementType& Value)
+		{
+			State.Set(Index, Value, Owner);
+		}
+
+		void Set(SizeType Index, ElementType&& Value)
+		{
+			State.Set(Index, MoveTempIfPossible(Value), Owner);
+		}
+
+		void Pop()
+		{
+			State.Pop(Owner);
+		}
+
+		SizeType Num() const
+		{
+			return State.Count;
+		}
+
+		const ElementType& operator[](SizeType Index) const
+		{
+			return State.GetLeaf(Index)->GetData()[Index & BranchMask];
+		}
+
+		/** Ends the batch: @return the built vector. The transient is left empty. */
+		TPersistentVector Persistent()
+		{
+			TPersistentVector Result;
+			Result.State = State;
+			State = FState();
+			return Result;
+		}
+
+	private:
+		friend class TPersistentVector;
+
+		explicit FTransient(const FState& InState)
+			: State(InState)
+			, Owner(NextOwnerId.fetch_add(1, std::memory_order_relaxed))
+		{
+			State.AddRefAll();
+		}
+
+		FState   State;
+		FOwnerId Owner;
+	};
+
+	/** Iterates over the elements of one version, looking up each leaf only once. */
+	class TConstIterator
+	{
+	public:
+		TConstIterator(const FState& InState, SizeType InIndex)
+			: State(InState)
+			, Index(InIndex)
+			, LeafData(InIndex < InState.Count ? InState.GetLeaf(InIndex)->GetData() : nullptr)
+		{ }
+
+		TConstIterator& operator++()
+		{
+			++Index;
+			if ((Index & BranchMask) == 0 && Index < State.Count)
+			{
+				LeafData = State.GetLeaf(Index)->GetData();
+			}
+			return *this;
+		}
+
+		const ElementType& operator*() const
+		{
+			return LeafData[Index & BranchMask];
+		}
+
+		const ElementType* operator->() const
+		{
+			return &LeafData[Index & BranchMask];
+		}
+
+		SizeType GetIndex() const
+		{
+			return Index;
+		}
+
+		bool operator!=(const TConstIterator& Rhs) const
+		{
+			return Index != Rhs.Index;
+		}
+
+		bool operator==(const TConstIterator& Rhs) const
+		{
+			return Index == Rhs.Index;
+		}
+
+	private:
+		const FState&      State;
+		SizeType           Index;
+		const ElementType* LeafData;
+	};
+
+public:
+	TPersistentVector() = default;
+
+	TPersistentVector(const TPersistentVector& Other)
+		: State(Other.State)
+	{
+		State.AddRefAll();
+	}
+
+	TPersistentVector(TPersistentVector&& Other)
+		: State(Other.State)
+	{
+		Other.State = FState();
+	}
+
+	~TPersistentVector()
+	{
+		State.ReleaseAll();
+	}
+
+	TPersistentVector& operator=(const TPersistentVector& Other)
+	{
+		if (this != &Other)
+		{
+			Other.State.AddRefAll();
+			State.ReleaseAll();
+			State = Other.State;
+		}
+		return *this;
+	}
+
+	TPersistentVector& operator=(TPersistentVector&& Other)
+	{
+		if (this != &Other)
+		{
+			State.ReleaseAll();
+			State = Other.State;
+			Other.State = FState();
+		}
+		return *this;
+	}
+
+	/** @return a new version with Value appended. */
+	TPersistentVector Push(const ElementType& Value) const
+	{
+		TPersistentVector Result(*this);
+		Result.State.Push(Value, 0);
+		return Result;
+	}
+
+	TPersistentVector Push(ElementType&& Value) const
+	{
+		TPersistentVector Result(*this);
+		Result.State.Push(MoveTempIfPossible(Value), 0);
+		return Result;
+	}
+
+	/** @return a new version with the element at Index replaced by Value. */
+	TPersistentVector Set(SizeType Index, const ElementType& Value) const
+	{
+		TPersistentVector Result(*this);
+		Result.State.Set(Index, Value, 0);
+		return Result;
+	}
+
+	TPersistentVector Set(SizeType Index, ElementType&& Value) const
+	{
+		TPersistentVector Result(*this);
+		Result.State.Set(Index, MoveTempIfPossible(Value), 0);
+		return Result;
+	}
+
+	/** @return a new version without the last element. */
+	TPersistentVector Pop() const
+	{
+		TPersistentVector Result(*this);
+		Result.State.Pop(0);
+		return Result;
+	}
+
+	/** @return a transient which starts from this version, for batch edits. This version is unaffected. */
+	FTransient Transient() const
+	{
+		return FTransient(State);
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		return State.GetLeaf(Index)->GetData()[Index & BranchMask];
+	}
+
+	const ElementType& Last() const
+	{
+		return (*this)[State.Count - 1];
+	}
+
+	SizeType Num() const
+	{
+		return State.Count;
+	}
+
+	bool IsEmpty() const
+	{
+		return State.Count == 0;
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < State.Count;
+	}
+
+	/** @return a TArray holding a copy of the elements. */
+	TArray<ElementType> ToArray() const
+	{
+		TArray<ElementType> Result;
+		Result.Reserve(State.Count);
+		for (SizeType Index = 0; Index < State.Count; Index += BranchFactor)
+		{
+			FLeafNode* Leaf = State.GetLeaf(Index);
+			const SizeType FirstNew = Result.AddUninitialized((SizeType)Leaf->Num);
+			ConstructItems<ElementType>(Result.GetData() + FirstNew, Leaf->GetData(), Leaf->Num);
+		}
+		return Result;
+	}
+
+	/** @return a vector holding a copy of the elements of Array. */
+	static TPersistentVector FromArray(const TArray<ElementType>& Array)
+	{
+		FTransient Builder = TPersistentVector().Transient();
+		for (const ElementType& Element : Array)
+		{
+			Builder.Push(Element);
+		}
+		return Builder.Persistent();
+	}
+
+	/** @return true if both versions share the same root and tail, i.e. are the same version. */
+	bool IsIdenticalTo(const TPersistentVector& Other) const
+	{
+		return State.Root == Other.State.Root && State.Tail == Other.State.Tail && State.Count == Other.State.Count;
+	}
+
+private:
+	static void AddRef(FNode* Node)
+	{
+		if (Node)
+		{
+			Node->RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	/** Drops a reference to Node, which is at Level in the trie (0 for leaves), freeing it and its subtree with the last one. */
+	static void Release(FNode* Node, std::uint32_t Level)
+	{
+		if (!Node || Node->RefCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+
+		if (Level == 0)
+		{
+			delete (FLeafNode*)Node;
+			return;
+		}
+
+		FInnerNode* Inner = (FInnerNode*)Node;
+		for (FNode* Child : Inner->Children)
+		{
+			Release(Child, Level - BranchBits);
+		}
+		delete Inner;
+	}
+
+	/** @return Leaf if Owner may edit it in place, otherwise a copy which replaces the caller's reference to Leaf. */
+	static FLeafNode* MakeEditable(FLeafNode* Leaf, FOwnerId Owner)
+	{
+		if (Owner && Leaf->Owner == Owner)
+		{
+			return Leaf;
+		}
+
+		FLeafNode* Copy = new FLeafNode(Owner);
+		ConstructItems<ElementType>(Copy->GetData(), Leaf->GetData(), Leaf->Num);
+		Copy->Num = Leaf->Num;
+		Release(Leaf, 0);
+		return Copy;
+	}
+
+	static FInnerNode* MakeEditable(FInnerNode* Node, std::uint32_t Level, FOwnerId Owner)
+	{
+		if (Owner && Node->Owner == Owner)
+		{
+			return Node;
+		}
+
+		FInnerNode* Copy = new FInnerNode(Owner);
+		for (std::uint32_t Index = 0; Index < BranchFactor; ++Index)
+		{
+			Copy->Children[Index] = Node->Children[Index];
+			AddRef(Copy->Children[Index]);
+		}
+		Release(Node, Level);
+		return Copy;
+	}
+
+	friend TConstIterator begin(const TPersistentVector& Vector) { return TConstIterator(Vector.State, 0); }
+	friend TConstIterator end  (const TPersistentVector& Vector) { return TConstIterator(Vector.State, Vector.State.Count); }
+
+	inline static std::atomic<FOwnerId> NextOwnerId{ 1 };
+
+	FState State;
+};
@@ -0,0 +1,524 @@
+#pragma once
+#include <thread>
+#include "ArrayView.h"
+
+/**
+ * Lazy, fused pipelines over arrays.
+ *
+ * Each stage only records what to do; nothing runs until a terminal operation (ToArray, ForEach, Count, ...) is called.
+ * The terminal then makes a single pass over the source, pushing each element through every stage, so no intermediate
+ * arrays are built and the source is read once. When the size of the result is known up front (no Filter), ToArray
+ * allocates it exactly once.
+ *
+ * Usage:
+ *		TArray<int32> Ids = Pipeline::From(Requests)
+ *			.Filter([](const FRequest& Request) { return Request.bValid; })
+ *			.Transform([](const FRequest& Request) { return Request.Id; })
+ *			.Take(100)
+ *			.ToArray();
+ *
+ * Parallel() splits the source into contiguous slices, one per thread, and concatenates the slices' results in order,
+ * so the result is the same as the serial one. Pipelines containing Take depend on the elements before each slice and
+ * therefore run serially even when Parallel() is requested. Stage functors must be safe to call concurrently.
+ *
+ * Every stage implements:
+ *		ValueType											- the type passed to the next stage
+ *		SizeType GetSourceNum() const						- the number of source elements
+ *		SizeType GetExactNum(Begin, End) const				- the number of values produced from a slice of the source, or Pipeline::UnknownNum if unknown
+ *		bool Run(Begin, End, Sink) const					- pushes the values produced from a slice of the source into Sink, which returns
+ *															  false to stop; returns false if stopped early
+ */
+template <typename DerivedType>
+class TPipeline;
+
+template <typename UpstreamType, typename PredicateType>
+class TPipelineFilter;
+
+template <typename UpstreamType, typename FuncType>
+class TPipelineTransform;
+
+template <typename UpstreamType>
+class TPipelineTake;
+
+template <typename PipelineType>
+class TParallelPipeline;
+
+namespace Pipeline
+{
+	/** Returned by GetExactNum when the number of values can't be known without running the pipeline. */
+	inline constexpr std::int32_t UnknownNum = -1;
+}
+
+/** Stage chaining and the terminal operations, shared by every stage. */
+template <typename DerivedType>
+class TPipeline
+{
+public:
+	typedef std::int32_t SizeType;
+
+	/** @return a pipeline which only keeps the values for which Predicate returns true. */
+	template <typename PredicateType>
+	TPipelineFilter<DerivedType, PredicateType> Filter(PredicateType Predicate) const
+	{
+		return TPipelineFilter<DerivedType, PredicateType>(GetDerived(), Predicate);
+	}
+
+	/** @return a pipeline which replaces every value with Func(Value). */
+	template <typename FuncType>
+	TPipelineTransform<DerivedType, FuncType> Transform(FuncType Func) const
+	{
+		return TPipelineTransform<DerivedType, FuncType>(GetDerived(), Func);
+	}
+
+	/** @return a pipeline which stops after MaxNum values. */
+	TPipelineTake<DerivedType> Take(SizeType MaxNum) const
+	{
+		return TPipelineTake<DerivedType>(GetDerived(), MaxNum);
+	}
+
+	/**
+	 * @return a pipeline whose terminal operations split the work across threads.
+	 *
+	 * @param NumThreads Number of threads to use, including the calling one; 0 picks one per hardware thread.
+	 */
+	TParallelPipeline<DerivedType> Parallel(std::int32_t NumThreads = 0) const
+	{
+		return TParallelPipeline<DerivedType>(GetDerived(), NumThreads);
+	}
+
+	/** Calls Func with every value, in order. */
+	template <typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		GetDerived().Run(0, GetDerived().GetSourceNum(), [&Func](auto&& Value)
+		{
+			Func(std::forward<decltype(Value)>(Value));
+			return true;
+		});
+	}
+
+	/** @return an array holding every value, in order. */
+	auto ToArray() const
+	{
+		TArray<std::decay_t<typename DerivedType::ValueType>> Result;
+		const SizeType ExactNum = GetDerived().GetExactNum(0, GetDerived().GetSourceNum());
+		if (ExactNum != Pipeline::UnknownNum)
+		{
+			Result.Reserve(ExactNum);
+		}
+
+		GetDerived().Run(0, GetDerived().GetSourceNum(), [&Result](auto&& Value)
+		{
+			Result.Emplace(std::forward<decltype(Value)>(Value));
+			return true;
+		});
+		return Result;
+	}
+
+	/** @return the number of values. */
+	SizeType Count() const
+	{
+		const SizeType ExactNum = GetDerived().GetExactNum(0, GetDerived().GetSourceNum());
+		if (ExactNum != Pipeline::UnknownNum)
+		{
+			return ExactNum;
+		}
+
+		SizeType Result = 0;
+		GetDerived().Run(0, GetDerived().GetSourceNum(), [&Result](auto&&)
+		{
+			++Result;
+			return true;
+		});
+		return Result;
+	}
+
+	/**
+	 * Finds the first value for which Predicate returns true, stopping as soon as it is found.
+	 *
+	 * @param OutValue Receives the value if one is found.
+	 * @return true if a value was found.
+	 */
+	template <typename PredicateType, typename OutValueType>
+	bool FindFirst(PredicateType Predicate, OutValueType& OutValue) const
+	{
+		bool bFound = false;
+		GetDerived().Run(0, GetDerived().GetSourceNum(), [&Predicate, &OutValue, &bFound](auto&& Value)
+		{
+			if (!Predicate(Value))
+			{
+				return true;
+			}
+			OutValue = std::forward<decltype(Value)>(Value);
+			bFound = true;
+			return false;
+		});
+		return bFound;
+	}
+
+	/** @return true if Predicate returns true for any value, stopping as soon as one is found. */
+	template <typename PredicateType>
+	bool Any(PredicateType Predicate) const
+	{
+		return !GetDerived().Run(0, GetDerived().GetSourceNum(), [&Predicate](auto&& Value)
+		{
+			return !Predicate(Value);
+		});
+	}
+
+	/** @return Op(...Op(Op(Init, Value0), Value1)..., ValueN). */
+	template <typename ResultType, typename OpType>
+	ResultType Reduce(ResultType Init, OpType Op) const
+	{
+		GetDerived().Run(0, GetDerived().GetSourceNum(), [&Init, &Op](auto&& Value)
+		{
+			Init = Op(MoveTempIfPossible(Init), std::forward<decltype(Value)>(Value));
+			return true;
+		});
+		return Init;
+	}
+
+protected:
+	const DerivedType& GetDerived() const
+	{
+		return static_cast<const DerivedType&>(*this);
+	}
+};
+
+/** The first stage of every pipeline: the elements of an array, in order. */
+template <typename InElementType>
+class TPipelineSource : public TPipeline<TPipelineSource<InElementType>>
+{
+public:
+	typedef const InElementType& ValueType;
+	typedef std::int32_t         SizeType;
+
+	static constexpr bool bIsOrderIndependent = true;
+
+	explicit TPipelineSource(TArrayView<const InElementType> InSource)
+		: Source(InSource)
+	{ }
+
+	SizeType GetSourceNum() const
+	{
+		return Source.Num();
+	}
+
+	SizeType GetExactNum(SizeType Begin, SizeType End) const
+	{
+		return End - Begin;
+	}
+
+	template <typename SinkType>
+	bool Run(SizeType Begin, SizeType End, SinkType&& Sink) const
+	{
+		const InElementType* Data = Source.GetData();
+		for (SizeType Index = Begin; Index < End; ++Index)
+		{
+			if (!Sink(Data[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	TArrayView<const InElementType> Source;
+};
+
+/** Passes on only the values for which Predicate returns true. */
+template <typename UpstreamType, typename PredicateType>
+class TPipelineFilter : public TPipeline<TPipelineFilter<UpstreamType, PredicateType>>
+{
+public:
+	typedef typename UpstreamType::ValueType ValueType;
+	typedef std::int32_t                     SizeType;
+
+	static constexpr bool bIsOrderIndependent = UpstreamType::bIsOrderIndependent;
+
+	TPipelineFilter(const UpstreamType& InUpstream, PredicateType InPredicate)
+		: Upstream(InUpstream)
+		, Predicate(InPredicate)
+	{ }
+
+	SizeType GetSourceNum() const
+	{
+		return Upstream.GetSourceNum();
+	}
+
+	SizeType GetExactNum(SizeType, SizeType) const
+	{
+		return Pipeline::UnknownNum;
+	}
+
+	template <typename SinkType>
+	bool Run(SizeType Begin, SizeType End, SinkType&& Sink) const
+	{
+		return Upstream.Run(Begin, End, [this, &Sink](ValueType Value)
+		{
+			return !Predicate(Value) || Sink(std::forward<ValueType>(Value));
+		});
+	}
+
+private:
+	UpstreamType  Upstream;
+	PredicateType Predicate;
+};
+
+/** Passes on Func(Value) for every value. */
+template <typename UpstreamType, typename FuncType>
+class TPipelineTransform : public TPipeline<TPipelineTransform<UpstreamType, FuncType>>
+{
+public:
+	typedef std::invoke_result_t<const FuncType&, typename UpstreamType::ValueType> ValueType;
+	typedef std::int32_t                                                            SizeType;
+
+	static constexpr bool bIsOrderIndependent = UpstreamType::bIsOrderIndependent;
+
+	TPipelineTransform(const UpstreamType& InUpstream, FuncType InFunc)
+		: Upstream(InUpstream)
+		, Func(InFunc)
+	{ }
+
+	SizeType GetSourceNum() const
+	{
+		return Upstream.GetSourceNum();
+	}
+
+	SizeType GetExactNum(SizeType Begin, SizeType End) const
+	{
+		return Upstream.GetExactNum(Begin, End);
+	}
+
+	template <typename SinkType>
+	bool Run(SizeType Begin, SizeType End, SinkType&& Sink) const
+	{
+		return Upstream.Run(Begin, End, [this, &Sink](typename UpstreamType::ValueType Value)
+		{
+			return Sink(Func(std::forward<typename UpstreamType::ValueType>(Value)));
+		});
+	}
+
+private:
+	UpstreamType Upstream;
+	FuncType     Func;
+};
+
+/** Passes on the first MaxNum values, and stops reading the source once it has them. */
+template <typename UpstreamType>
+class TPipelineTake : public TPipeline<TPipelineTake<UpstreamType>>
+{
+public:
+	typedef typename UpstreamType::ValueType ValueType;
+	typedef std::int32_t                     SizeType;
+
+	static constexpr bool bIsOrderIndependent = false;
+
+	TPipelineTake(const UpstreamType& InUpstream, SizeType InMaxNum)
+		: Upstream(InUpstream)
+		, MaxNum(InMaxNum)
+	{
+		_ASSERT(MaxNum >= 0);
+	}
+
+	SizeType GetSourceNum() const
+	{
+		return Upstream.GetSourceNum();
+	}
+
+	SizeType GetExactNum(SizeType Begin, SizeType End) const
+	{
+		const SizeType UpstreamNum = Upstream.GetExactNum(Begin, End);
+		return UpstreamNum == Pipeline::UnknownNum ? Pipeline::UnknownNum : (UpstreamNum < MaxNum ? UpstreamNum : MaxNum);
+	}
+
+	template <typename SinkType>
+	bool Run(SizeType Begin, SizeType End, SinkType&& Sink) const
+	{
+		if (MaxNum == 0)
+		{
+			return true;
+		}
+
+		// Running out of values to take stops the upstream too, but only the sink stopping counts as stopping early.
+		SizeType Remaining = MaxNum;
+		bool bSinkStopped = false;
+		Upstream.Run(Begin, End, [&Remaining, &bSinkStopped, &Sink](ValueType Value)
+		{
+			if (!Sink(std::forward<ValueType>(Value)))
+			{
+				bSinkStopped = true;
+				return false;
+			}
+			return --Remaining > 0;
+		});
+		return !bSinkStopped;
+	}
+
+private:
+	UpstreamType Upstream;
+	SizeType     MaxNum;
+};
+
+/** Runs the terminal operations of a pipeline across several threads. See the comment at the top of the file. */
+template <typename PipelineType>
+class TParallelPipeline
+{
+public:
+	typedef std::int32_t                                        SizeType;
+	typedef std::decay_t<typename PipelineType::ValueType>      ResultElementType;
+
+	/** Slices smaller than this aren't worth a thread. */
+	static constexpr SizeType MinSliceNum = 4096;
+
+	TParallelPipeline(const PipelineType& InPipeline, std::int32_t InNumThreads)
+		: Stages(InPipeline)
+		, NumThreads(InNumThreads > 0 ? InNumThreads : (std::int32_t)std::thread::hardware_concurrency())
+	{ }
+
+	/** @return an array holding every value, in the same order as the serial pipeline. */
+	TArray<ResultElementType> ToArray() const
+	{
+		const SizeType NumSlices = GetNumSlices();
+		if (NumSlices <= 1)
+		{
+			return Stages.ToArray();
+		}
+
+		const SizeType SourceNum = Stages.GetSourceNum();
+		TArray<ResultElementType> Result;
+		if (Stages.GetExactNum(0, SourceNum) != Pipeline::UnknownNum)
+		{
+			// Every slice knows where its output goes, so the threads construct straight into the result.
+			Result.AddUninitialized(Stages.GetExactNum(0, SourceNum));
+			ResultElementType* ResultData = Result.GetData();
+			RunSlices(NumSlices, [this, ResultData](SizeType, SizeType Begin, SizeType End)
+			{
+				ResultElementType* Dest = ResultData + Stages.GetExactNum(0, Begin);
+				Stages.Run(Begin, End, [&Dest](auto&& Value)
+				{
+					new(Dest++) ResultElementType(std::forward<decltype(Value)>(Value));
+					return true;
+				});
+			});
+			return Result;
+		}
+
+		TArray<TArray<ResultElementType>> SliceResults;
+		SliceResults.Reserve(NumSlices);
+		for (SizeType SliceIndex = 0; SliceIndex < NumSlices; ++SliceIndex)
+		{
+			SliceResults.Emplace();
+		}
+		RunSlices(NumSlices, [this, &SliceResults](SizeType SliceIndex, SizeType Begin, SizeType End)
+		{
+			TArray<ResultElementType>& SliceResult = SliceResults[SliceIndex];
+			Stages.Run(Begin, End, [&SliceResult](auto&& Value)
+			{
+				SliceResult.Emplace(std::forward<decltype(Value)>(Value));
+				return true;
+			});
+		});
+
+		SizeType TotalNum = 0;
+		for (const TArray<ResultElementType>& SliceResult : SliceResults)
+		{
+			TotalNum += SliceResult.Num();
+		}
+		Result.Reserve(TotalNum);
+		for (TArray<ResultElementType>& SliceResult : SliceResults)
+		{
+			for (ResultElementType& Value : SliceResult)
+			{
+				Result.Emplace(MoveTempIfPossible(Value));
+			}
+		}
+		return Result;
+	}
+
+	/** @return the number of values. */
+	SizeType Count() const
+	{
+		const SizeType NumSlices = GetNumSlices();
+		if (NumSlices <= 1)
+		{
+			return Stages.Count();
+		}
+
+		TArray<SizeType> SliceCounts;
+		SliceCounts.AddZeroed(NumSlices);
+		RunSlices(NumSlices, [this, &SliceCounts](SizeType SliceIndex, SizeType Begin, SizeType End)
+		{
+			SizeType& SliceCount = SliceCounts[SliceIndex];
+			Stages.Run(Begin, End, [&SliceCount](auto&&)
+			{
+				++SliceCount;
+				return true;
+			});
+		});
+
+		SizeType Result = 0;
+		for (SizeType SliceCount : SliceCounts)
+		{
+			Result += SliceCount;
+		}
+		return Result;
+	}
+
+private:
+	SizeType GetNumSlices() const
+	{
+		if (!PipelineType::bIsOrderIndependent)
+		{
+			return 1;
+		}
+
+		const SizeType MaxSlices = Stages.GetSourceNum() / MinSliceNum;
+		return NumThreads < MaxSlices ? NumThreads : (MaxSlices > 0 ? MaxSlices : 1);
+	}
+
+	/** Calls Func(SliceIndex, Begin, End) for every slice, the first one on the calling thread. */
+	template <typename FuncType>
+	void RunSlices(SizeType NumSlices, const FuncType& Func) const
+	{
+		const SizeType SourceNum = Stages.GetSourceNum();
+		const auto GetSliceBegin = [SourceNum, NumSlices](SizeType SliceIndex)
+		{
+			return SizeType(std::int64_t(SourceNum) * SliceIndex / NumSlices);
+		};
+
+		TArray<std::thread> Threads;
+		Threads.Reserve(NumSlices - 1);
+		for (SizeType SliceIndex = 1; SliceIndex < NumSlices; ++SliceIndex)
+		{
+			Threads.Emplace(Func, SliceIndex, GetSliceBegin(SliceIndex), GetSliceBegin(SliceIndex + 1));
+		}
+
+		Func(0, GetSliceBegin(0), GetSliceBegin(1));
+
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+	}
+
+	PipelineType Stages;
+	std::int32_t NumThreads;
+};
+
+namespace Pipeline
+{
+	/** @return a pipeline reading the elements of Array, which must outlive it. */
+	template <typename ElementType>
+	TPipelineSource<ElementType> From(const TArray<ElementType>& Array)
+	{
+		return TPipelineSource<ElementType>(TArrayView<const ElementType>(Array));
+	}
+
+	template <typename ElementType>
+	TPipelineSource<std::remove_const_t<ElementType>> From(TArrayView<ElementType> View)
+	{
+		return TPipelineSource<std::remove_const_t<ElementType>>(TArrayView<const std::remove_const_t<ElementType>>(View.GetData(), View.Num()));
+	}
+}
\ No newline at end of file
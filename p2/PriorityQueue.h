@@ -0,0 +1,189 @@
+#pragma once
+#include "Array.h"
+#include "SparseArray.h"
+
+/**
+ * A priority queue with stable handles, so queued elements can be re-prioritized or removed in O(log N).
+ *
+ * The heap itself is a TArray of handles; the elements live in a TSparseArray indexed by handle, each
+ * remembering its current position in the heap. Every time the heap moves a handle, the element's
+ * position is updated, which is what makes Update (decrease-key / increase-key) and Remove possible
+ * without searching the heap.
+ *
+ * Top() is the element for which Predicate(Element, Other) holds for all others, so TLess gives a min-queue.
+ * The heap is 4-ary by default; pass Arity = 2 for a binary heap.
+ */
+template <typename InElementType, typename PredicateType = TLess<InElementType>, int Arity = 4>
+class TPriorityQueue
+{
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+	typedef std::int32_t  FHandle;
+
+	inline const static FHandle INVALID_HANDLE = -1;
+
+private:
+	struct FEntry
+	{
+		template <typename ArgType>
+		FEntry(ArgType&& InValue)
+			: Value(std::forward<ArgType>(InValue))
+			, HeapIndex(0)
+		{ }
+
+		ElementType Value;
+		SizeType    HeapIndex;
+	};
+
+	/** Orders handles by the elements they refer to. */
+	struct FHandlePredicate
+	{
+		const TPriorityQueue& Queue;
+
+		bool operator()(FHandle A, FHandle B) const
+		{
+			return Queue.Predicate(Queue.Entries[A].Value, Queue.Entries[B].Value);
+		}
+	};
+
+	/** Records the new heap position of a handle whenever the heap moves it. */
+	struct FTrackHeapIndex
+	{
+		TPriorityQueue& Queue;
+
+		void operator()(FHandle Handle, SizeType NewHeapIndex) const
+		{
+			Queue.Entries[Handle].HeapIndex = NewHeapIndex;
+		}
+	};
+
+public:
+	explicit TPriorityQueue(PredicateType InPredicate = PredicateType())
+		: Predicate(InPredicate)
+	{ }
+
+	/**
+	 * Adds an element to the queue.
+	 *
+	 * @return A handle which identifies the element until it is popped or removed.
+	 */
+	FHandle Push(const ElementType& Element)
+	{
+		return Emplace(Element);
+	}
+
+	FHandle Push(ElementType&& Element)
+	{
+		return Emplace(MoveTempIfPossible(Element));
+	}
+
+	template <typename ArgType>
+	FHandle Emplace(ArgType&& Arg)
+	{
+		const FHandle Handle = Entries.Emplace(std::forward<ArgType>(Arg));
+		Heap.Add(Handle);
+		AlgoImpl::HeapSiftUp<Arity>(Heap.GetData(), Heap.Num() - 1, FHandlePredicate{ *this }, FTrackHeapIndex{ *this });
+		return Handle;
+	}
+
+	/** @return the element at the top of the queue. */
+	const ElementType& Top() const
+	{
+		_ASSERT(!IsEmpty());
+		return Entries[Heap[0]].Value;
+	}
+
+	/** @return the handle of the element at the top of the queue. */
+	FHandle TopHandle() const
+	{
+		_ASSERT(!IsEmpty());
+		return Heap[0];
+	}
+
+	/**
+	 * Removes the top element from the queue.
+	 *
+	 * @return The removed element.
+	 */
+	ElementType Pop()
+	{
+		_ASSERT(!IsEmpty());
+		const FHandle Handle = Heap[0];
+		ElementType Result = MoveTempIfPossible(Entries[Handle].Value);
+		Remove(Handle);
+		return Result;
+	}
+
+	/** Removes the element identified by Handle from the queue. */
+	void Remove(FHandle Handle)
+	{
+		_ASSERT(Contains(Handle));
+		AlgoImpl::HeapRemoveAtInternal<Arity>(Heap.GetData(), Entries[Handle].HeapIndex, Heap.Num(), FHandlePredicate{ *this }, FTrackHeapIndex{ *this });
+		Heap.RemoveAt(Heap.Num() - 1, 1, false);
+		Entries.RemoveAt(Handle);
+	}
+
+	/**
+	 * Replaces the element identified by Handle and restores the heap order.
+	 * Works in either direction, so this covers both decrease-key and increase-key.
+	 */
+	void Update(FHandle Handle, const ElementType& NewValue)
+	{
+		_ASSERT(Contains(Handle));
+		Entries[Handle].Value = NewValue;
+		Reheap(Handle);
+	}
+
+	void Update(FHandle Handle, ElementType&& NewValue)
+	{
+		_ASSERT(Contains(Handle));
+		Entries[Handle].Value = MoveTempIfPossible(NewValue);
+		Reheap(Handle);
+	}
+
+	/** @return true if Handle refers to an element in the queue. */
+	bool Contains(FHandle Handle) const
+	{
+		return Entries.IsValidIndex(Handle);
+	}
+
+	/** @return the element identified by Handle. Use Update to change it. */
+	const ElementType& operator[](FHandle Handle) const
+	{
+		return Entries[Handle].Value;
+	}
+
+	SizeType Num() const
+	{
+		return Heap.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Heap.IsEmpty();
+	}
+
+	void Reserve(SizeType Number)
+	{
+		Heap.Reserve(Number);
+		Entries.Reserve(Number);
+	}
+
+	void Empty()
+	{
+		Heap.Empty();
+		Entries.Empty();
+	}
+
+private:
+	void Reheap(FHandle Handle)
+	{
+		const SizeType NewIndex = AlgoImpl::HeapSiftUp<Arity>(Heap.GetData(), Entries[Handle].HeapIndex, FHandlePredicate{ *this }, FTrackHeapIndex{ *this });
+		AlgoImpl::HeapSiftDown<Arity>(Heap.GetData(), NewIndex, Heap.Num(), FHandlePredicate{ *this }, FTrackHeapIndex{ *this });
+	}
+
+	TArray<FHandle>      Heap;
+	TSparseArray<FEntry> Entries;
+	PredicateType        Predicate;
+};
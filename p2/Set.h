@@ -0,0 +1,502 @@
+#pragma once
+#include "Array.h"
+#include "TypeHash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SET_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define SET_USE_SSE2 0
+#endif
+
+/**
+ * The base KeyFuncs type with some useful definitions for all KeyFuncs; meant to be derived from instead of used directly.
+ */
+template <typename ElementType>
+struct DefaultKeyFuncs
+{
+	typedef ElementType        KeyType;
+	typedef const ElementType& KeyInitType;
+	typedef const ElementType& ElementInitType;
+
+	/**
+	 * @return The key used to index the given element.
+	 */
+	static KeyInitType GetSetKey(ElementInitType Element)
+	{
+		return Element;
+	}
+
+	/**
+	 * @return True if the keys match.
+	 */
+	static bool Matches(KeyInitType A, KeyInitType B)
+	{
+		return A == B;
+	}
+
+	/** Calculates a hash index for a key. */
+	static std::uint64_t GetKeyHash(KeyInitType Key)
+	{
+		return GetTypeHash(Key);
+	}
+};
+
+/**
+ * A group of control bytes, probed with one compare when SSE2 is available.
+ * Each slot of the hash table has one control byte: the top seven bits of the
+ * hash when the slot is full, or ControlEmpty when it is not. There is no
+ * "deleted" state; removal shifts entries back instead of leaving tombstones.
+ */
+struct FSetControlGroup
+{
+	static constexpr std::uint32_t Width = 16;
+	static constexpr std::int8_t   ControlEmpty = -128;
+
+#if SET_USE_SSE2
+	explicit FSetControlGroup(const std::int8_t* Controls)
+		: Group(_mm_loadu_si128((const __m128i*)Controls))
+	{ }
+
+	/** @return a bit mask of the slots whose control byte equals H2. */
+	std::uint32_t Match(std::int8_t H2) const
+	{
+		return (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Group));
+	}
+
+	/** @return a bit mask of the empty slots; empty is the only control value with the sign bit set. */
+	std::uint32_t MatchEmpty() const
+	{
+		return (std::uint32_t)_mm_movemask_epi8(Group);
+	}
+
+private:
+	__m128i Group;
+#else
+	explicit FSetControlGroup(const std::int8_t* Controls)
+		: Group(Controls)
+	{ }
+
+	std::uint32_t Match(std::int8_t H2) const
+	{
+		std::uint32_t Mask = 0;
+		for (std::uint32_t Index = 0; Index < Width; ++Index)
+		{
+			Mask |= std::uint32_t(Group[Index] == H2) << Index;
+		}
+		return Mask;
+	}
+
+	std::uint32_t MatchEmpty() const
+	{
+		std::uint32_t Mask = 0;
+		for (std::uint32_t Index = 0; Index < Width; ++Index)
+		{
+			Mask |= std::uint32_t(Group[Index] < 0) << Index;
+		}
+		return Mask;
+	}
+
+private:
+	const std::int8_t* Group;
+#endif
+};
+
+/**
+ * A set with an optional KeyFuncs parameters for customizing how the elements are compared and searched.
+ * The elements are kept densely packed in a TArray, so iterating a set is a linear walk over memory.
+ * Lookup goes through an open-addressing index (Swiss-table style): a control byte per slot holds
+ * 7 bits of the hash, and 16 control bytes are compared at once, so most failed probes never touch
+ * the elements at all.
+ *
+ * Removing an element swaps the last element into its place, so element order and indices are not stable.
+ */
+template <typename InElementType, typename KeyFuncs = DefaultKeyFuncs<InElementType>>
+class TSet
+{
+public:
+	typedef InElementType                        ElementType;
+	typedef typename KeyFuncs::KeyInitType       KeyInitType;
+	typedef typename KeyFuncs::ElementInitType   ElementInitType;
+	typedef std::int32_t                         SizeType;
+
+	inline const static SizeType INDEX_NONE = -1;
+
+private:
+	static constexpr std::int8_t   ControlEmpty = FSetControlGroup::ControlEmpty;
+	static constexpr std::uint32_t GroupWidth = FSetControlGroup::Width;
+	static constexpr SizeType      MinCapacity = 16;
+
+public:
+	TSet()
+		: Capacity(0)
+	{ }
+
+	/**
+	 * Adds an element to the set, replacing an existing element with a matching key.
+	 *
+	 * @param	InElement			Element to add to set
+	 * @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether element is already in set
+	 * @return	the index of the element in the set.
+	 */
+	SizeType Add(const ElementType& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+	{
+		return Emplace(InElement, bIsAlreadyInSetPtr);
+	}
+
+	SizeType Add(ElementType&& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+	{
+		return Emplace(MoveTempIfPossible(InElement), bIsAlreadyInSetPtr);
+	}
+
+	/**
+	 * Adds an element to the set, constructing it in place at the end of the element array.
+	 *
+	 * @param	Arg					The argument to be forwarded to the element's constructor.
+	 * @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether element is already in set
+	 * @return	the index of the element in the set.
+	 */
+	template <typename ArgType>
+	SizeType Emplace(ArgType&& Arg, bool* bIsAlreadyInSetPtr = nullptr)
+	{
+		const SizeType NewIndex = Elements.Emplace(std::forward<ArgType>(Arg));
+		ElementType& NewElement = Elements[NewIndex];
+
+		const std::uint64_t Hash = KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(NewElement));
+		const SizeType ExistingSlot = FindSlot(KeyFuncs::GetSetKey(NewElement), Hash);
+		const bool bIsAlreadyInSet = ExistingSlot != INDEX_NONE;
+		if (bIsAlreadyInSetPtr)
+		{
+			*bIsAlreadyInSetPtr = bIsAlreadyInSet;
+		}
+
+		if (bIsAlreadyInSet)
+		{
+			// Replace the existing element and drop the one we just built.
+			const SizeType ExistingIndex = Slots[ExistingSlot];
+			Elements[ExistingIndex] = MoveTempIfPossible(NewElement);
+			Elements.RemoveAt(NewIndex, 1, false);
+			return ExistingIndex;
+		}
+
+		if (ShouldGrow(Elements.Num()))
+		{
+			Rehash(Capacity ? Capacity * 2 : MinCapacity);
+		}
+		else
+		{
+			LinkElement(NewIndex, Hash);
+		}
+		return NewIndex;
+	}
+
+	/**
+	 * Removes the element with the given key.
+	 *
+	 * @param	Key		The key of the element to remove.
+	 * @return	The number of elements removed.
+	 */
+	SizeType Remove(KeyInitType Key)
+	{
+		const SizeType Slot = FindSlot(Key, KeyFuncs::GetKeyHash(Key));
+		if (Slot == INDEX_NONE)
+		{
+			return 0;
+		}
+
+		const SizeType ElementIndex = Slots[Slot];
+		UnlinkSlot(Slot);
+
+		// Fill the hole with the last element, and point its slot at the new location.
+		const SizeType LastIndex = Elements.Num() - 1;
+		if (ElementIndex != LastIndex)
+		{
+			Slots[FindSlotOfIndex(LastIndex)] = ElementIndex;
+		}
+		Elements.RemoveAtSwap(ElementIndex, 1, false);
+		return 1;
+	}
+
+	/**
+	 * Finds an element with the given key in the set.
+	 *
+	 * @param	Key		The key to search for.
+	 * @return	A pointer to an element with the given key.  If no element in the set has the given key, this will return nullptr.
+	 */
+	ElementType* Find(KeyInitType Key)
+	{
+		const SizeType Slot = FindSlot(Key, KeyFuncs::GetKeyHash(Key));
+		return Slot != INDEX_NONE ? &Elements[Slots[Slot]] : nullptr;
+	}
+
+	const ElementType* Find(KeyInitType Key) const
+	{
+		return const_cast<TSet*>(this)->Find(Key);
+	}
+
+	/**
+	 * Finds the index of an element with the given key in the set.
+	 *
+	 * @return	The index of the element, or INDEX_NONE.
+	 */
+	SizeType FindIndex(KeyInitType Key) const
+	{
+		const SizeType Slot = FindSlot(Key, KeyFuncs::GetKeyHash(Key));
+		return Slot != INDEX_NONE ? Slots[Slot] : INDEX_NONE;
+	}
+
+	bool Contains(KeyInitType Key) const
+	{
+		return FindSlot(Key, KeyFuncs::GetKeyHash(Key)) != INDEX_NONE;
+	}
+
+	/**
+	 * Preallocates enough memory to contain Number elements, so that adding up to
+	 * Number elements causes neither a reallocation of the elements nor a rehash.
+	 */
+	void Reserve(SizeType Number)
+	{
+		_ASSERT(Number >= 0);
+		Elements.Reserve(Number);
+
+		SizeType NewCapacity = Capacity ? Capacity : MinCapacity;
+		while (ShouldGrow(Number, NewCapacity))
+		{
+			NewCapacity *= 2;
+		}
+		if (NewCapacity != Capacity)
+		{
+			Rehash(NewCapacity);
+		}
+	}
+
+	/**
+	 * Removes all elements from the set, potentially leaving space allocated for an expected number of elements about to be added.
+	 *
+	 * @param	ExpectedNumElements		The number of elements about to be added to the set.
+	 */
+	void Empty(SizeType ExpectedNumElements = 0)
+	{
+		Elements.Empty(ExpectedNumElements);
+		Controls.Empty();
+		Slots.Empty();
+		Capacity = 0;
+		if (ExpectedNumElements)
+		{
+			Reserve(ExpectedNumElements);
+		}
+	}
+
+	/** Efficiently empties out the set but preserves all allocations and capacities. */
+	void Reset()
+	{
+		Elements.Reset();
+		if (Capacity)
+		{
+			memset(Controls.GetData(), ControlEmpty, Controls.Num());
+		}
+	}
+
+	SizeType Num() const
+	{
+		return Elements.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Elements.IsEmpty();
+	}
+
+	/** @return the number of slots in the hash index. */
+	SizeType GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	ElementType& operator[](SizeType Index)
+	{
+		return Elements[Index];
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		return Elements[Index];
+	}
+
+	/** @return the densely packed elements of the set. */
+	const TArray<ElementType>& Array() const
+	{
+		return Elements;
+	}
+
+private:
+	static std::int8_t GetH2(std::uint64_t Hash)
+	{
+		return (std::int8_t)(Hash & 0x7F);
+	}
+
+	static std::uint32_t GetH1(std::uint64_t Hash)
+	{
+		return (std::uint32_t)(Hash >> 7);
+	}
+
+	/** Keeps the load factor at or below 7/8, so every probe sequence reaches an empty slot. */
+	static bool ShouldGrow(SizeType NumElements, SizeType InCapacity)
+	{
+		return std::int64_t(NumElements) * 8 > std::int64_t(InCapacity) * 7;
+	}
+
+	bool ShouldGrow(SizeType NumElements) const
+	{
+		return ShouldGrow(NumElements, Capacity);
+	}
+
+	std::uint32_t GetSlotMask() const
+	{
+		return (std::uint32_t)Capacity - 1;
+	}
+
+	/**
+	 * Sets the control byte of a slot. The first GroupWidth - 1 control bytes are
+	 * mirrored after the end of the table so a group can be loaded at any slot without wrapping.
+	 */
+	void SetControl(std::uint32_t Slot, std::int8_t Control)
+	{
+		std::int8_t* RESTRICT ControlData = Controls.GetData();
+		ControlData[Slot] = Control;
+		if (Slot < GroupWidth - 1)
+		{
+			ControlData[Capacity + Slot] = Control;
+		}
+	}
+
+	SizeType FindSlot(KeyInitType Key, std::uint64_t Hash) const
+	{
+		if (!Capacity)
+		{
+			return INDEX_NONE;
+		}
+
+		const std::int8_t H2 = GetH2(Hash);
+		const std::uint32_t Mask = GetSlotMask();
+		const ElementType* RESTRICT ElementData = Elements.GetData();
+		for (std::uint32_t Pos = GetH1(Hash) & Mask; ; Pos = (Pos + GroupWidth) & Mask)
+		{
+			const FSetControlGroup Group(Controls.GetData() + Pos);
+			const std::uint32_t EmptyMask = Group.MatchEmpty();
+			std::uint32_t MatchMask = Group.Match(H2);
+			if (EmptyMask)
+			{
+				// A key is never stored past the first empty slot of its probe sequence.
+				MatchMask &= (EmptyMask & (0u - EmptyMask)) - 1;
+			}
+
+			while (MatchMask)
+			{
+				const std::uint32_t Slot = (Pos + CountTrailingZeros(MatchMask)) & Mask;
+				if (KeyFuncs::Matches(KeyFuncs::GetSetKey(ElementData[Slots[Slot]]), Key))
+				{
+					return (SizeType)Slot;
+				}
+				MatchMask &= MatchMask - 1;
+			}
+
+			if (EmptyMask)
+			{
+				return INDEX_NONE;
+			}
+		}
+	}
+
+	/** Finds the slot referencing the element at ElementIndex without comparing keys. */
+	SizeType FindSlotOfIndex(SizeType ElementIndex) const
+	{
+		const std::uint64_t Hash = KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Elements[ElementIndex]));
+		const std::int8_t H2 = GetH2(Hash);
+		const std::uint32_t Mask = GetSlotMask();
+		for (std::uint32_t Pos = GetH1(Hash) & Mask; ; Pos = (Pos + GroupWidth) & Mask)
+		{
+			std::uint32_t MatchMask = FSetControlGroup(Controls.GetData() + Pos).Match(H2);
+			while (MatchMask)
+			{
+				const std::uint32_t Slot = (Pos + CountTrailingZeros(MatchMask)) & Mask;
+				if (Slots[Slot] == ElementIndex)
+				{
+					return (SizeType)Slot;
+				}
+				MatchMask &= MatchMask - 1;
+			}
+		}
+	}
+
+	/** Stores ElementIndex in the first empty slot of its probe sequence. */
+	void LinkElement(SizeType ElementIndex, std::uint64_t Hash)
+	{
+		const std::uint32_t Mask = GetSlotMask();
+		for (std::uint32_t Pos = GetH1(Hash) & Mask; ; Pos = (Pos + GroupWidth) & Mask)
+		{
+			const std::uint32_t EmptyMask = FSetControlGroup(Controls.GetData() + Pos).MatchEmpty();
+			if (EmptyMask)
+			{
+				const std::uint32_t Slot = (Pos + CountTrailingZeros(EmptyMask)) & Mask;
+				SetControl(Slot, GetH2(Hash));
+				Slots[Slot] = ElementIndex;
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Empties a slot without leaving a tombstone. Probing is linear, so every
+	 * following entry up to the next empty slot is shifted back into the hole
+	 * unless the hole lies before its home slot.
+	 */
+	void UnlinkSlot(SizeType Slot)
+	{
+		const std::uint32_t Mask = GetSlotMask();
+		std::uint32_t Hole = (std::uint32_t)Slot;
+		for (std::uint32_t Next = (Hole + 1) & Mask; Controls[Next] != ControlEmpty; Next = (Next + 1) & Mask)
+		{
+			const std::uint64_t Hash = KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Elements[Slots[Next]]));
+			const std::uint32_t Home = GetH1(Hash) & Mask;
+			if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+			{
+				SetControl(Hole, Controls[Next]);
+				Slots[Hole] = Slots[Next];
+				Hole = Next;
+			}
+		}
+		SetControl(Hole, ControlEmpty);
+	}
+
+	/** Rebuilds the hash index with the given number of slots. */
+	void Rehash(SizeType NewCapacity)
+	{
+		_ASSERT(NewCapacity >= MinCapacity && (NewCapacity & (NewCapacity - 1)) == 0);
+
+		Capacity = NewCapacity;
+
+		Controls.Reset();
+		Controls.AddUninitialized(NewCapacity + GroupWidth - 1);
+		memset(Controls.GetData(), ControlEmpty, Controls.Num());
+
+		Slots.Reset();
+		Slots.AddUninitialized(NewCapacity);
+
+		for (SizeType Index = 0, Count = Elements.Num(); Index < Count; ++Index)
+		{
+			LinkElement(Index, KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Elements[Index])));
+		}
+	}
+
+private:
+	TArray<ElementType>  Elements;
+	TArray<std::int8_t>  Controls;
+	TArray<SizeType>     Slots;
+	SizeType             Capacity;
+
+	friend       ElementType* begin(      TSet& Set) { return begin(Set.Elements); }
+	friend const ElementType* begin(const TSet& Set) { return begin(Set.Elements); }
+	friend       ElementType* end  (      TSet& Set) { return end  (Set.Elements); }
+	friend const ElementType* end  (const TSet& Set) { return end  (Set.Elements); }
+};
\ No newline at end of file
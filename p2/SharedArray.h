@@ -0,0 +1,246 @@
+#pragma once
+#include <atomic>
+#include "ArrayView.h"
+
+/**
+ * A copy-on-write array: copies share one atomically reference-counted TArray, so copying is O(1) no matter how
+ * big the array is. The first mutation through a copy which is not the only reference gives it a private copy.
+ *
+ * Reads never copy. Mutation goes through the explicit mutators below or GetMutable(), never through operator[],
+ * so an innocent read on a non-const array can't trigger a deep copy.
+ *
+ * Usage:
+ *		TSharedArray<FConfigEntry> Entries = TSharedArray<FConfigEntry>::Freeze(MoveTemp(LoadedEntries));
+ *		TSharedArray<FConfigEntry> Snapshot = Entries;	// O(1)
+ *		Entries.Add(NewEntry);							// Entries gets its own copy; Snapshot is unaffected
+ */
+template <typename InElementType>
+class TSharedArray
+{
+public:
+	typedef InElementType        ElementType;
+	typedef std::int32_t         SizeType;
+	typedef TArray<ElementType>  ArrayType;
+
+private:
+	struct FSharedData
+	{
+		explicit FSharedData(ArrayType&& InArray)
+			: RefCount(1)
+			, Array(MoveTempIfPossible(InArray))
+		{ }
+
+		explicit FSharedData(const ArrayType& InArray)
+			: RefCount(1)
+			, Array(InArray)
+		{ }
+
+		/** Allocated through the memory layer, charged to the shared array type; the array's own buffer is charged to TArray. */
+		static void* operator new(std::size_t Size)
+		{
+			return FMemory::Realloc(nullptr, Size, &GetMemoryTypeTag<TSharedArray>());
+		}
+
+		static void operator delete(void* Ptr)
+		{
+			FMemory::Free(Ptr);
+		}
+
+		std::atomic<std::int32_t> RefCount;
+		ArrayType                 Array;
+	};
+
+public:
+	TSharedArray()
+		: SharedData(nullptr)
+	{ }
+
+	/** Takes over the contents of Array without copying. */
+	explicit TSharedArray(ArrayType&& Array)
+		: SharedData(Array.Num() ? new FSharedData(MoveTempIfPossible(Array)) : nullptr)
+	{ }
+
+	explicit TSharedArray(const ArrayType& Array)
+		: SharedData(Array.Num() ? new FSharedData(Array) : nullptr)
+	{ }
+
+	TSharedArray(const TSharedArray& Other)
+		: SharedData(Other.SharedData)
+	{
+		AddRef();
+	}
+
+	TSharedArray(TSharedArray&& Other)
+		: SharedData(Other.SharedData)
+	{
+		Other.SharedData = nullptr;
+	}
+
+	~TSharedArray()
+	{
+		Release();
+	}
+
+	TSharedArray& operator=(const TSharedArray& Other)
+	{
+		if (SharedData != Other.SharedData)
+		{
+			Release();
+			SharedData = Other.SharedData;
+			AddRef();
+		}
+		return *this;
+	}
+
+	TSharedArray& operator=(TSharedArray&& Other)
+	{
+		if (this != &Other)
+		{
+			Release();
+			SharedData = Other.SharedData;
+			Other.SharedData = nullptr;
+		}
+		return *this;
+	}
+
+	/**
+	 * Turns an array into a shared buffer without copying it. Array is left empty.
+	 * Every copy of the result shares the buffer until one of them is mutated.
+	 */
+	static TSharedArray Freeze(ArrayType&& Array)
+	{
+		return TSharedArray(MoveTempIfPossible(Array));
+	}
+
+	SizeType Num() const
+	{
+		return SharedData ? SharedData->Array.Num() : 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < Num();
+	}
+
+	const ElementType* GetData() const
+	{
+		return SharedData ? SharedData->Array.GetData() : nullptr;
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return SharedData->Array[Index];
+	}
+
+	TArrayView<const ElementType> GetView() const
+	{
+		return TArrayView<const ElementType>(GetData(), Num());
+	}
+
+	/** @return true if no other TSharedArray refers to the same buffer, so mutating won't copy. */
+	bool IsUnique() const
+	{
+		return !SharedData || SharedData->RefCount.load(std::memory_order_acquire) == 1;
+	}
+
+	/** @return true if both arrays refer to the same buffer. */
+	bool SharesDataWith(const TSharedArray& Other) const
+	{
+		return SharedData == Other.SharedData;
+	}
+
+	/**
+	 * @return the underlying array for mutation, copying it first if it is shared.
+	 * The reference is invalidated by copying this TSharedArray.
+	 */
+	ArrayType& GetMutable()
+	{
+		Detach();
+		return SharedData->Array;
+	}
+
+	/** @return a private copy of the elements as a plain array. */
+	ArrayType ToArray() const
+	{
+		return SharedData ? SharedData->Array : ArrayType();
+	}
+
+	template <typename... ArgsType>
+	SizeType Emplace(ArgsType&&... Args)
+	{
+		return GetMutable().Emplace(std::forward<ArgsType>(Args)...);
+	}
+
+	SizeType Add(const ElementType& Item)
+	{
+		return GetMutable().Add(Item);
+	}
+
+	SizeType Add(ElementType&& Item)
+	{
+		return GetMutable().Add(MoveTempIfPossible(Item));
+	}
+
+	void RemoveAt(SizeType Index, SizeType Count = 1)
+	{
+		GetMutable().RemoveAt(Index, Count);
+	}
+
+	/** Replaces the element at Index. */
+	void Set(SizeType Index, const ElementType& Item)
+	{
+		_ASSERT(IsValidIndex(Index));
+		GetMutable()[Index] = Item;
+	}
+
+	/** Drops this reference to the elements; other copies keep theirs. */
+	void Empty()
+	{
+		Release();
+		SharedData = nullptr;
+	}
+
+private:
+	void AddRef()
+	{
+		if (SharedData)
+		{
+			SharedData->RefCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void Release()
+	{
+		// Acquire-release so the last owner sees every write made through the other owners before deleting.
+		if (SharedData && SharedData->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete SharedData;
+		}
+	}
+
+	/** Makes sure this is the only reference to the buffer, copying it if necessary. */
+	void Detach()
+	{
+		if (!SharedData)
+		{
+			SharedData = new FSharedData(ArrayType());
+		}
+		else if (!IsUnique())
+		{
+			FSharedData* Copy = new FSharedData(SharedData->Array);
+			Release();
+			SharedData = Copy;
+		}
+	}
+
+	friend const ElementType* begin(const TSharedArray& Array) { return Array.GetData(); }
+	friend const ElementType* end  (const TSharedArray& Array) { return Array.GetData() + Array.Num(); }
+
+	FSharedData* SharedData;
+};
@@ -0,0 +1,417 @@
+#pragma once
+#include "List.h"
+#include "Pair.h"
+
+/**
+ * An ordered map with O(log n) expected search, insertion and removal: a skip list of key/value pairs.
+ *
+ * The bottom level is a doubly linked list in key order, and its nodes have the same interface as
+ * TDoubleLinkedList's (GetValue, GetNextNode, GetPrevNode), so the list is iterated with TDoubleLinkedListIterator
+ * like any other. Each node also has a tower of forward links of random height (a quarter of the nodes reach each
+ * level above the one below), which searches skip along from the top down.
+ *
+ * Nodes are variable-sized, so they are pooled by tower height: each height has its own free list, refilled a slab
+ * at a time. Empty() frees all the slabs at once.
+ *
+ * Range queries: LowerBound and UpperBound find the first node at or past a key, and ForEachInRange visits a key
+ * range in order.
+ *
+ * Elements are TPair<const KeyType, ValueType>, so iterators and GetValue can change a value but never its key,
+ * which would break the order.
+ */
+template <typename InKeyType, typename InValueType, typename PredicateType = TLess<InKeyType>>
+class TSkipList
+{
+public:
+	typedef InKeyType                       KeyType;
+	typedef InValueType                     ValueType;
+	typedef TPair<const KeyType, ValueType> ElementType;
+	typedef std::int32_t                    SizeType;
+
+	/** Enough levels for 4^MaxHeight elements. */
+	static constexpr std::int32_t MaxHeight = 16;
+
+	class FNode
+	{
+	public:
+		const ElementType& GetValue() const
+		{
+			return Value;
+		}
+
+		ElementType& GetValue()
+		{
+			return Value;
+		}
+
+		FNode* GetNextNode() const
+		{
+			return GetTower()[0];
+		}
+
+		FNode* GetPrevNode() const
+		{
+			return PrevNode;
+		}
+
+		std::int32_t GetHeight() const
+		{
+			return Height;
+		}
+
+	private:
+		friend class TSkipList;
+
+		/** The tower of forward links lives right after the node: Tower[Level] is the next node at that level. */
+		FNode** GetTower() const
+		{
+			return (FNode**)(this + 1);
+		}
+
+		ElementType  Value;
+		FNode*       PrevNode;
+		std::int32_t Height;
+	};
+
+	typedef TDoubleLinkedListIterator<FNode,       ElementType> TIterator;
+	typedef TDoubleLinkedListIterator<FNode, const ElementType> TConstIterator;
+
+	TSkipList()
+		: TailNode(nullptr)
+		, ListSize(0)
+		, CurrentHeight(1)
+		, RandomState(0x9E3779B9u)
+		, Slabs(nullptr)
+	{
+		for (std::int32_t Level = 0; Level < MaxHeight; ++Level)
+		{
+			HeadTower[Level] = nullptr;
+			FreeLists[Level] = nullptr;
+		}
+	}
+
+	~TSkipList()
+	{
+		Empty();
+	}
+
+	TSkipList(const TSkipList&) = delete;
+	TSkipList& operator=(const TSkipList&) = delete;
+
+	/**
+	 * Sets the value for a key, adding the key if it isn't there yet.
+	 *
+	 * @return A reference to the value as stored in the list, valid until its key is removed.
+	 */
+	ValueType& Add(const KeyType& InKey, const ValueType& InValue)
+	{
+		FNode** Update[MaxHeight];
+		FNode*  BottomPrev;
+		FNode*  Existing = FindPredecessors(InKey, Update, BottomPrev);
+		if (Existing && !Predicate(InKey, Existing->Value.Key))
+		{
+			Existing->Value.Value = InValue;
+			return Existing->Value.Value;
+		}
+
+		const std::int32_t Height = RandomHeight();
+		for (std::int32_t Level = CurrentHeight; Level < Height; ++Level)
+		{
+			Update[Level] = HeadTower;
+		}
+		CurrentHeight = Height > CurrentHeight ? Height : CurrentHeight;
+
+		FNode* NewNode = AllocateNode(Height);
+		new(&NewNode->Value) ElementType(InKey, InValue);
+		NewNode->Height = Height;
+
+		FNode** NewTower = NewNode->GetTower();
+		for (std::int32_t Level = 0; Level < Height; ++Level)
+		{
+			NewTower[Level] = Update[Level][Level];
+			Update[Level][Level] = NewNode;
+		}
+
+		NewNode->PrevNode = BottomPrev;
+		(NewTower[0] ? NewTower[0]->PrevNode : TailNode) = NewNode;
+
+		++ListSize;
+		return NewNode->Value.Value;
+	}
+
+	/**
+	 * Removes a key.
+	 *
+	 * @return Whether the key was in the list.
+	 */
+	bool Remove(const KeyType& InKey)
+	{
+		FNode** Update[MaxHeight];
+		FNode*  BottomPrev;
+		FNode*  Node = FindPredecessors(InKey, Update, BottomPrev);
+		if (!Node || Predicate(InKey, Node->Value.Key))
+		{
+			return false;
+		}
+
+		FNode** Tower = Node->GetTower();
+		for (std::int32_t Level = 0; Level < Node->Height; ++Level)
+		{
+			Update[Level][Level] = Tower[Level];
+		}
+		(Tower[0] ? Tower[0]->PrevNode : TailNode) = BottomPrev;
+
+		while (CurrentHeight > 1 && HeadTower[CurrentHeight - 1] == nullptr)
+		{
+			--CurrentHeight;
+		}
+
+		DestructItem(&Node->Value);
+		FreeNode(Node);
+		--ListSize;
+		return true;
+	}
+
+	/** Removes every element and frees all node memory. */
+	void Empty()
+	{
+		for (FNode* Node = HeadTower[0]; Node; Node = Node->GetNextNode())
+		{
+			DestructItem(&Node->Value);
+		}
+
+		while (Slabs)
+		{
+			void* Data = Slabs;
+			Slabs = Slabs->NextSlab;
+			ResizeAllocation(Data, 1, 0, 1, &GetMemoryTypeTag<TSkipList>());
+		}
+
+		for (std::int32_t Level = 0; Level < MaxHeight; ++Level)
+		{
+			HeadTower[Level] = nullptr;
+			FreeLists[Level] = nullptr;
+		}
+		TailNode      = nullptr;
+		ListSize      = 0;
+		CurrentHeight = 1;
+	}
+
+	// Accessors.
+
+	/** @return a pointer to the value for Key, or nullptr if the key isn't in the list. */
+	ValueType* Find(const KeyType& InKey)
+	{
+		FNode* Node = LowerBound(InKey);
+		return Node && !Predicate(InKey, Node->Value.Key) ? &Node->Value.Value : nullptr;
+	}
+
+	const ValueType* Find(const KeyType& InKey) const
+	{
+		return const_cast<TSkipList*>(this)->Find(InKey);
+	}
+
+	bool Contains(const KeyType& InKey) const
+	{
+		return Find(InKey) != nullptr;
+	}
+
+	/** @return the node holding Key, or nullptr. */
+	FNode* FindNode(const KeyType& InKey) const
+	{
+		FNode* Node = LowerBound(InKey);
+		return Node && !Predicate(InKey, Node->Value.Key) ? Node : nullptr;
+	}
+
+	/** @return the first node whose key isn't before InKey, or nullptr if there is none. */
+	FNode* LowerBound(const KeyType& InKey) const
+	{
+		return Search([this, &InKey](const KeyType& NodeKey) { return Predicate(NodeKey, InKey); });
+	}
+
+	/** @return the first node whose key is after InKey, or nullptr if there is none. */
+	FNode* UpperBound(const KeyType& InKey) const
+	{
+		return Search([this, &InKey](const KeyType& NodeKey) { return !Predicate(InKey, NodeKey); });
+	}
+
+	/**
+	 * Calls Func(Element) for every element with a key in [MinKey, MaxKey), in order.
+	 *
+	 * @return the number of elements visited.
+	 */
+	template <typename FuncType>
+	SizeType ForEachInRange(const KeyType& MinKey, const KeyType& MaxKey, FuncType&& Func) const
+	{
+		SizeType Count = 0;
+		for (FNode* Node = LowerBound(MinKey); Node && Predicate(Node->Value.Key, MaxKey); Node = Node->GetNextNode())
+		{
+			Func((const ElementType&)Node->Value);
+			++Count;
+		}
+		return Count;
+	}
+
+	/** @return the node with the smallest key, or nullptr if the list is empty. */
+	FNode* GetHead() const
+	{
+		return HeadTower[0];
+	}
+
+	/** @return the node with the largest key, or nullptr if the list is empty. */
+	FNode* GetTail() const
+	{
+		return TailNode;
+	}
+
+	bool IsEmpty() const
+	{
+		return ListSize == 0;
+	}
+
+	SizeType Num() const
+	{
+		return ListSize;
+	}
+
+private:
+	/** A block of nodes of one height, carved into the free list of that height. */
+	struct FSlab
+	{
+		FSlab* NextSlab;
+	};
+
+	/** Free nodes are linked through the first word of their storage. */
+	struct FFreeNode
+	{
+		FFreeNode* Next;
+	};
+
+	static constexpr std::size_t GetNodeSize(std::int32_t Height)
+	{
+		return (sizeof(FNode) + sizeof(FNode*) * Height + alignof(FNode) - 1) / alignof(FNode) * alignof(FNode);
+	}
+
+	static constexpr std::size_t SlabHeaderSize = (sizeof(FSlab) + alignof(FNode) - 1) / alignof(FNode) * alignof(FNode);
+
+	FNode* AllocateNode(std::int32_t Height)
+	{
+		static_assert(alignof(FNode) <= 16, "Keys and values aligned beyond 16 bytes are not supported");
+
+		FFreeNode*& FreeList = FreeLists[Height - 1];
+		if (!FreeList)
+		{
+			// Aim for about a kilobyte per slab, so the rare tall nodes don't tie up much memory.
+			const std::size_t NodeSize = GetNodeSize(Height);
+			const std::size_t NumNodes = NodeSize < 1024 ? 1024 / NodeSize : 1;
+
+			void* Data = nullptr;
+			ResizeAllocation(Data, 0, SlabHeaderSize + NodeSize * NumNodes, 1, &GetMemoryTypeTag<TSkipList>());
+			FSlab* Slab = (FSlab*)Data;
+			Slab->NextSlab = Slabs;
+			Slabs = Slab;
+
+			unsigned char* FirstNode = (unsigned char*)Data + SlabHeaderSize;
+			for (std::size_t Index = NumNodes; Index-- > 0; )
+			{
+				FFreeNode* Free = (FFreeNode*)(FirstNode + Index * NodeSize);
+				Free->Next = FreeList;
+				FreeList = Free;
+			}
+		}
+
+		FFreeNode* Free = FreeList;
+		FreeList = Free->Next;
+		return (FNode*)Free;
+	}
+
+	void FreeNode(FNode* Node)
+	{
+		FFreeNode* Free = (FFreeNode*)Node;
+		FFreeNode*& FreeList = FreeLists[Node->Height - 1];
+		Free->Next = FreeList;
+		FreeList = Free;
+	}
+
+	/** Picks a tower height: 1, and one more with a probability of 1/4 each time. */
+	std::int32_t RandomHeight()
+	{
+		// xorshift32
+		RandomState ^= RandomState << 13;
+		RandomState ^= RandomState >> 17;
+		RandomState ^= RandomState << 5;
+
+		std::uint32_t Bits = RandomState;
+		std::int32_t Height = 1;
+		while ((Bits & 3) == 0 && Height < MaxHeight)
+		{
+			++Height;
+			Bits >>= 2;
+		}
+		return Height;
+	}
+
+	/**
+	 * Walks down from the top level, moving right while IsBefore(NextKey) holds.
+	 *
+	 * @return the first node at the bottom level for which IsBefore is false.
+	 */
+	template <typename IsBeforeType>
+	FNode* Search(const IsBeforeType& IsBefore) const
+	{
+		FNode* const* Tower = HeadTower;
+		for (std::int32_t Level = CurrentHeight - 1; Level >= 0; --Level)
+		{
+			while (FNode* Next = Tower[Level])
+			{
+				if (!IsBefore(Next->Value.Key))
+				{
+					break;
+				}
+				Tower = Next->GetTower();
+			}
+		}
+		return Tower[0];
+	}
+
+	/**
+	 * Finds, at every level, the tower whose link would point at a node with InKey.
+	 *
+	 * @param	OutUpdate		receives the tower at every level up to CurrentHeight.
+	 * @param	OutBottomPrev	receives the last node before InKey at the bottom level, or nullptr.
+	 * @return the first node whose key isn't before InKey, or nullptr.
+	 */
+	FNode* FindPredecessors(const KeyType& InKey, FNode** OutUpdate[MaxHeight], FNode*& OutBottomPrev)
+	{
+		FNode** Tower = HeadTower;
+		OutBottomPrev = nullptr;
+		for (std::int32_t Level = CurrentHeight - 1; Level >= 0; --Level)
+		{
+			while (FNode* Next = Tower[Level])
+			{
+				if (!Predicate(Next->Value.Key, InKey))
+				{
+					break;
+				}
+				Tower = Next->GetTower();
+				OutBottomPrev = Next;
+			}
+			OutUpdate[Level] = Tower;
+		}
+		return Tower[0];
+	}
+
+	FNode*         HeadTower[MaxHeight];
+	FNode*         TailNode;
+	SizeType       ListSize;
+	std::int32_t   CurrentHeight;
+	std::uint32_t  RandomState;
+	PredicateType  Predicate;
+	FSlab*         Slabs;
+	FFreeNode*     FreeLists[MaxHeight];
+
+	friend TIterator      begin(      TSkipList& List) { return TIterator     (List.GetHead()); }
+	friend TConstIterator begin(const TSkipList& List) { return TConstIterator(List.GetHead()); }
+	friend TIterator      end  (      TSkipList&     ) { return TIterator     (nullptr); }
+	friend TConstIterator end  (const TSkipList&     ) { return TConstIterator(nullptr); }
+};
\ No newline at end of file
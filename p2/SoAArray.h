@@ -0,0 +1,343 @@
+#pragma once
+#include <new>
+#include <tuple>
+#include <utility>
+#include "ArrayView.h"
+
+/**
+ * A structure-of-arrays container: each field of a logical row is stored in its own buffer, so a loop which
+ * only touches one or two fields streams through exactly the memory it uses. The field buffers share a single
+ * Num/Max and grow together.
+ *
+ * Every field buffer is aligned to FieldAlignment bytes, so GetField<I>() views can be handed to SIMD kernels.
+ *
+ * Usage:
+ *		TSoAArray<FVector3f, float> Particles;		// position, lifetime
+ *		Particles.Add(Position, 1.0f);
+ *		for (float& Lifetime : Particles.GetField<1>()) { Lifetime -= DeltaTime; }
+ */
+template <typename... FieldTypes>
+class TSoAArray
+{
+	static_assert(sizeof...(FieldTypes) > 0, "TSoAArray needs at least one field");
+
+public:
+	typedef std::int32_t SizeType;
+
+	template <std::size_t FieldIndex>
+	using TFieldType = std::tuple_element_t<FieldIndex, std::tuple<FieldTypes...>>;
+
+	static constexpr std::size_t NumFields      = sizeof...(FieldTypes);
+	static constexpr std::size_t FieldAlignment = 64;
+
+public:
+	TSoAArray()
+		: ArrayNum(0)
+		, ArrayMax(0)
+	{
+		for (void*& Field : FieldData)
+		{
+			Field = nullptr;
+		}
+	}
+
+	TSoAArray(const TSoAArray& Other)
+		: TSoAArray()
+	{
+		*this = Other;
+	}
+
+	TSoAArray(TSoAArray&& Other)
+		: ArrayNum(Other.ArrayNum)
+		, ArrayMax(Other.ArrayMax)
+	{
+		for (std::size_t Index = 0; Index < NumFields; ++Index)
+		{
+			FieldData[Index] = Other.FieldData[Index];
+			Other.FieldData[Index] = nullptr;
+		}
+		Other.ArrayNum = 0;
+		Other.ArrayMax = 0;
+	}
+
+	~TSoAArray()
+	{
+		Empty();
+	}
+
+	TSoAArray& operator=(const TSoAArray& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Reserve(Other.ArrayNum);
+			ForEachField([this, &Other](auto FieldIndexConstant)
+			{
+				constexpr std::size_t FieldIndex = decltype(FieldIndexConstant)::value;
+				ConstructItems<TFieldType<FieldIndex>>(GetFieldData<FieldIndex>(), Other.template GetFieldData<FieldIndex>(), Other.ArrayNum);
+			});
+			ArrayNum = Other.ArrayNum;
+		}
+		return *this;
+	}
+
+	TSoAArray& operator=(TSoAArray&& Other)
+	{
+		if (this != &Other)
+		{
+			Empty();
+			for (std::size_t Index = 0; Index < NumFields; ++Index)
+			{
+				FieldData[Index] = Other.FieldData[Index];
+				Other.FieldData[Index] = nullptr;
+			}
+			ArrayNum = Other.ArrayNum;
+			ArrayMax = Other.ArrayMax;
+			Other.ArrayNum = 0;
+			Other.ArrayMax = 0;
+		}
+		return *this;
+	}
+
+	/** A reference to one row of the array, giving named-by-index access to its fields. */
+	template <bool bConst>
+	class TRowRef
+	{
+		typedef std::conditional_t<bConst, const TSoAArray, TSoAArray> ArrayType;
+
+	public:
+		TRowRef(ArrayType& InArray, SizeType InIndex)
+			: Array(InArray)
+			, Index(InIndex)
+		{ }
+
+		template <std::size_t FieldIndex>
+		std::conditional_t<bConst, const TFieldType<FieldIndex>&, TFieldType<FieldIndex>&> Get() const
+		{
+			return Array.template GetFieldData<FieldIndex>()[Index];
+		}
+
+		SizeType GetIndex() const
+		{
+			return Index;
+		}
+
+	private:
+		ArrayType& Array;
+		SizeType   Index;
+	};
+
+	typedef TRowRef<false> FRowRef;
+	typedef TRowRef<true>  FConstRowRef;
+
+	FRowRef operator[](SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		return FRowRef(*this, Index);
+	}
+
+	FConstRowRef operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return FConstRowRef(*this, Index);
+	}
+
+	/** @return a contiguous view of one field across all rows. */
+	template <std::size_t FieldIndex>
+	TArrayView<TFieldType<FieldIndex>> GetField()
+	{
+		return TArrayView<TFieldType<FieldIndex>>(GetFieldData<FieldIndex>(), ArrayNum);
+	}
+
+	template <std::size_t FieldIndex>
+	TArrayView<const TFieldType<FieldIndex>> GetField() const
+	{
+		return TArrayView<const TFieldType<FieldIndex>>(GetFieldData<FieldIndex>(), ArrayNum);
+	}
+
+	template <std::size_t FieldIndex>
+	TFieldType<FieldIndex>* GetFieldData()
+	{
+		return (TFieldType<FieldIndex>*)FieldData[FieldIndex];
+	}
+
+	template <std::size_t FieldIndex>
+	const TFieldType<FieldIndex>* GetFieldData() const
+	{
+		return (const TFieldType<FieldIndex>*)FieldData[FieldIndex];
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < ArrayNum;
+	}
+
+	bool IsEmpty() const
+	{
+		return ArrayNum == 0;
+	}
+
+	SizeType Num() const
+	{
+		return ArrayNum;
+	}
+
+	SizeType Max() const
+	{
+		return ArrayMax;
+	}
+
+	/**
+	 * Adds a row to the end of the array without constructing its fields.
+	 *
+	 * @return Index of the new row.
+	 */
+	SizeType AddUninitialized()
+	{
+		const SizeType Index = ArrayNum;
+		if (ArrayNum + 1 > ArrayMax)
+		{
+			ResizeTo(DefaultCalculateSlackGrow(ArrayNum + 1, ArrayMax, GetRowSize()));
+		}
+		++ArrayNum;
+		return Index;
+	}
+
+	/**
+	 * Adds a row, constructing each field from the corresponding argument.
+	 *
+	 * @return Index of the new row.
+	 */
+	template <typename... ArgTypes>
+	SizeType Emplace(ArgTypes&&... Args)
+	{
+		static_assert(sizeof...(ArgTypes) == NumFields, "TSoAArray::Emplace needs one argument per field");
+		const SizeType Index = AddUninitialized();
+		ConstructRow(Index, std::index_sequence_for<FieldTypes...>(), std::forward<ArgTypes>(Args)...);
+		return Index;
+	}
+
+	SizeType Add(const FieldTypes&... Values)
+	{
+		return Emplace(Values...);
+	}
+
+	/** Adds a row of value-initialized fields. */
+	SizeType AddDefaulted()
+	{
+		return Emplace(FieldTypes()...);
+	}
+
+	/**
+	 * Removes a row, moving the last row into its place. Does not preserve order.
+	 *
+	 * @param Index Row to remove.
+	 */
+	void RemoveAtSwap(SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		const SizeType LastIndex = ArrayNum - 1;
+		ForEachField([this, Index, LastIndex](auto FieldIndexConstant)
+		{
+			constexpr std::size_t FieldIndex = decltype(FieldIndexConstant)::value;
+			typedef TFieldType<FieldIndex> FieldType;
+			FieldType* Data = GetFieldData<FieldIndex>();
+			DestructItem(Data + Index);
+			if (Index != LastIndex)
+			{
+				RelocateConstructItems<FieldType>(Data + Index, Data + LastIndex, 1);
+			}
+		});
+		--ArrayNum;
+	}
+
+	/** Reserves memory such that every field can hold at least Number rows. */
+	void Reserve(SizeType Number)
+	{
+		_ASSERT(Number >= 0);
+		if (Number > ArrayMax)
+		{
+			ResizeTo(Number);
+		}
+	}
+
+	/** Removes all rows and frees the field buffers. */
+	void Empty()
+	{
+		Reset();
+		ResizeTo(0);
+	}
+
+	/** Removes all rows but keeps the field buffers. */
+	void Reset()
+	{
+		ForEachField([this](auto FieldIndexConstant)
+		{
+			constexpr std::size_t FieldIndex = decltype(FieldIndexConstant)::value;
+			DestructItems(GetFieldData<FieldIndex>(), ArrayNum);
+		});
+		ArrayNum = 0;
+	}
+
+	/** @return the number of bytes used by one row across all fields. */
+	static constexpr std::size_t GetRowSize()
+	{
+		return (sizeof(FieldTypes) + ...);
+	}
+
+private:
+	template <typename FuncType, std::size_t... FieldIndices>
+	static void ForEachFieldImpl(FuncType&& Func, std::index_sequence<FieldIndices...>)
+	{
+		(Func(std::integral_constant<std::size_t, FieldIndices>()), ...);
+	}
+
+	/** Calls Func(std::integral_constant<std::size_t, FieldIndex>) for every field. */
+	template <typename FuncType>
+	static void ForEachField(FuncType&& Func)
+	{
+		ForEachFieldImpl(Func, std::index_sequence_for<FieldTypes...>());
+	}
+
+	template <std::size_t... FieldIndices, typename... ArgTypes>
+	void ConstructRow(SizeType Index, std::index_sequence<FieldIndices...>, ArgTypes&&... Args)
+	{
+		(new(GetFieldData<FieldIndices>() + Index) TFieldType<FieldIndices>(std::forward<ArgTypes>(Args)), ...);
+	}
+
+	/** Reallocates every field buffer to hold NewMax rows, relocating the existing rows. */
+	void ResizeTo(SizeType NewMax)
+	{
+		_ASSERT(NewMax >= ArrayNum);
+		if (NewMax == ArrayMax)
+		{
+			return;
+		}
+
+		ForEachField([this, NewMax](auto FieldIndexConstant)
+		{
+			constexpr std::size_t FieldIndex = decltype(FieldIndexConstant)::value;
+			typedef TFieldType<FieldIndex> FieldType;
+
+			void* NewData = nullptr;
+			if (NewMax)
+			{
+				NewData = FMemory::MallocAligned(std::size_t(NewMax) * sizeof(FieldType), FieldAlignment, &GetMemoryTypeTag<TSoAArray>());
+				if (ArrayNum)
+				{
+					RelocateConstructItems<FieldType>(NewData, GetFieldData<FieldIndex>(), ArrayNum);
+				}
+			}
+			if (FieldData[FieldIndex])
+			{
+				FMemory::FreeAligned(FieldData[FieldIndex]);
+			}
+			FieldData[FieldIndex] = NewData;
+		});
+		ArrayMax = NewMax;
+	}
+
+	void*    FieldData[NumFields];
+	SizeType ArrayNum;
+	SizeType ArrayMax;
+};
\ No newline at end of file
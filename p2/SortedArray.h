@@ -0,0 +1,415 @@
+#pragma once
+#include "Array.h"
+#include "Pair.h"
+
+namespace AlgoImpl
+{
+	/**
+	 * Branchless lower bound: the loop has a fixed trip count of log2(Num) and the
+	 * step is selected with a conditional move, so there are no mispredicted branches.
+	 *
+	 * @return the index of the first element for which Predicate(Projection(Element), Value) is false.
+	 */
+	template <typename ElementType, typename SizeType, typename ValueType, typename ProjectionType, typename PredicateType>
+	SizeType LowerBoundBranchless(const ElementType* Data, SizeType Num, const ValueType& Value, ProjectionType Projection, PredicateType Predicate)
+	{
+		if (Num <= 0)
+		{
+			return 0;
+		}
+
+		const ElementType* Base = Data;
+		while (Num > 1)
+		{
+			const SizeType Half = Num / 2;
+			Base = Predicate(Projection(Base[Half]), Value) ? Base + Half : Base;
+			Num -= Half;
+		}
+		return SizeType(Base - Data) + SizeType(Predicate(Projection(*Base), Value));
+	}
+
+	/** @return the index of the first element for which Predicate(Value, Projection(Element)) is true. */
+	template <typename ElementType, typename SizeType, typename ValueType, typename ProjectionType, typename PredicateType>
+	SizeType UpperBoundBranchless(const ElementType* Data, SizeType Num, const ValueType& Value, ProjectionType Projection, PredicateType Predicate)
+	{
+		if (Num <= 0)
+		{
+			return 0;
+		}
+
+		const ElementType* Base = Data;
+		while (Num > 1)
+		{
+			const SizeType Half = Num / 2;
+			Base = !Predicate(Value, Projection(Base[Half])) ? Base + Half : Base;
+			Num -= Half;
+		}
+		return SizeType(Base - Data) + SizeType(!Predicate(Value, Projection(*Base)));
+	}
+
+	/**
+	 * Merges a sorted batch into a sorted array in one backward pass: the array is grown once and
+	 * each element is relocated at most once, so the merge costs O(Num + BatchNum).
+	 * Batch elements are moved from; equal elements from the batch are placed after the existing ones.
+	 */
+	template <typename ElementType, typename SizeType, typename ProjectionType, typename PredicateType>
+	void MergeSortedBatch(TArray<ElementType>& Array, ElementType* Batch, SizeType BatchNum, ProjectionType Projection, PredicateType Predicate)
+	{
+		if (!BatchNum)
+		{
+			return;
+		}
+
+		const SizeType OldNum = Array.Num();
+		Array.AddUninitialized(BatchNum);
+		ElementType* Data = Array.GetData();
+
+		SizeType ReadIndex = OldNum - 1;
+		SizeType BatchIndex = BatchNum - 1;
+		for (SizeType WriteIndex = OldNum + BatchNum - 1; BatchIndex >= 0; --WriteIndex)
+		{
+			if (ReadIndex >= 0 && Predicate(Projection(Batch[BatchIndex]), Projection(Data[ReadIndex])))
+			{
+				RelocateConstructItems<ElementType>(Data + WriteIndex, Data + ReadIndex, 1);
+				--ReadIndex;
+			}
+			else
+			{
+				new(Data + WriteIndex) ElementType(MoveTempIfPossible(Batch[BatchIndex]));
+				--BatchIndex;
+			}
+		}
+	}
+
+	struct FIdentityProjection
+	{
+		template <typename T>
+		const T& operator()(const T& Value) const
+		{
+			return Value;
+		}
+	};
+
+	struct FPairKeyProjection
+	{
+		template <typename PairType>
+		const auto& operator()(const PairType& Pair) const
+		{
+			return Pair.Key;
+		}
+	};
+}
+
+/**
+ * An array which keeps its elements sorted, for read-mostly lookup tables.
+ * Lookups are branchless binary searches over contiguous memory. Equal elements are allowed.
+ *
+ * Inserting one element at a time costs an O(Num) shift each; use InsertBatch for bulk updates,
+ * which sorts the batch and merges it in a single pass for O(Num + K log K).
+ */
+template <typename InElementType, typename PredicateType = TLess<InElementType>>
+class TSortedArray
+{
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	inline const static SizeType INDEX_NONE = -1;
+
+	explicit TSortedArray(PredicateType InPredicate = PredicateType())
+		: Predicate(InPredicate)
+	{ }
+
+	/**
+	 * Inserts an element at its sorted position, after any equal elements.
+	 *
+	 * @return Index of the element.
+	 */
+	SizeType Add(const ElementType& Item)
+	{
+		return Elements.Insert(Item, UpperBound(Item));
+	}
+
+	SizeType Add(ElementType&& Item)
+	{
+		const SizeType Index = UpperBound(Item);
+		return Elements.Insert(MoveTempIfPossible(Item), Index);
+	}
+
+	/**
+	 * Inserts a batch of elements. The batch is sorted and merged into the array in one pass.
+	 *
+	 * @param Batch The elements to insert; taken by value so it can be sorted in place.
+	 */
+	void InsertBatch(TArray<ElementType> Batch)
+	{
+		Batch.StableSort(Predicate);
+		AlgoImpl::MergeSortedBatch(Elements, Batch.GetData(), Batch.Num(), AlgoImpl::FIdentityProjection(), Predicate);
+	}
+
+	/** @return the index of the first element not less than Value. */
+	SizeType LowerBound(const ElementType& Value) const
+	{
+		return AlgoImpl::LowerBoundBranchless(Elements.GetData(), Elements.Num(), Value, AlgoImpl::FIdentityProjection(), Predicate);
+	}
+
+	/** @return the index of the first element greater than Value. */
+	SizeType UpperBound(const ElementType& Value) const
+	{
+		return AlgoImpl::UpperBoundBranchless(Elements.GetData(), Elements.Num(), Value, AlgoImpl::FIdentityProjection(), Predicate);
+	}
+
+	/** @return the index of an element equal to Value, or INDEX_NONE. */
+	SizeType Find(const ElementType& Value) const
+	{
+		const SizeType Index = LowerBound(Value);
+		return (Index < Elements.Num() && !Predicate(Value, Elements[Index])) ? Index : INDEX_NONE;
+	}
+
+	bool Contains(const ElementType& Value) const
+	{
+		return Find(Value) != INDEX_NONE;
+	}
+
+	/**
+	 * Removes every element equal to Value.
+	 *
+	 * @return Number of removed elements.
+	 */
+	SizeType Remove(const ElementType& Value)
+	{
+		const SizeType First = LowerBound(Value);
+		const SizeType Count = UpperBound(Value) - First;
+		Elements.RemoveAt(First, Count, false);
+		return Count;
+	}
+
+	void RemoveAt(SizeType Index, SizeType Count = 1)
+	{
+		Elements.RemoveAt(Index, Count, false);
+	}
+
+	void Reserve(SizeType Number)
+	{
+		Elements.Reserve(Number);
+	}
+
+	void Empty(SizeType Slack = 0)
+	{
+		Elements.Empty(Slack);
+	}
+
+	void Reset()
+	{
+		Elements.Reset();
+	}
+
+	SizeType Num() const
+	{
+		return Elements.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Elements.IsEmpty();
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		return Elements[Index];
+	}
+
+	/** @return the sorted elements. */
+	const TArray<ElementType>& Array() const
+	{
+		return Elements;
+	}
+
+private:
+	TArray<ElementType> Elements;
+	PredicateType       Predicate;
+
+	friend const ElementType* begin(const TSortedArray& Array) { return begin(Array.Elements); }
+	friend const ElementType* end  (const TSortedArray& Array) { return end  (Array.Elements); }
+};
+
+/**
+ * A map with unique keys, stored as a TArray of pairs sorted by key.
+ * Iteration is in key order over contiguous memory; lookups are branchless binary searches.
+ * Bulk updates should go through InsertBatch, which costs O(Num + K log K) for K pairs.
+ */
+template <typename InKeyType, typename InValueType, typename PredicateType = TLess<InKeyType>>
+class TFlatMap
+{
+public:
+	typedef InKeyType                 KeyType;
+	typedef InValueType               ValueType;
+	typedef TPair<KeyType, ValueType> ElementType;
+	typedef std::int32_t              SizeType;
+
+	explicit TFlatMap(PredicateType InPredicate = PredicateType())
+		: Predicate(InPredicate)
+	{ }
+
+	/**
+	 * Sets the value associated with a key.
+	 *
+	 * @return A reference to the value as stored in the map. The reference is only valid until the next change to any key in the map.
+	 */
+	template <typename InitKeyType, typename InitValueType>
+	ValueType& Add(InitKeyType&& InKey, InitValueType&& InValue)
+	{
+		const SizeType Index = LowerBound(InKey);
+		if (Index < Pairs.Num() && !Predicate(InKey, Pairs[Index].Key))
+		{
+			Pairs[Index].Value = std::forward<InitValueType>(InValue);
+		}
+		else
+		{
+			Pairs.EmplaceAt(Index, std::forward<InitKeyType>(InKey), std::forward<InitValueType>(InValue));
+		}
+		return Pairs[Index].Value;
+	}
+
+	/**
+	 * Sets the values of a batch of pairs. When a key appears more than once in the batch the last value wins.
+	 * Existing keys are updated in place and new keys are merged in with a single pass over the map.
+	 *
+	 * @param Batch The pairs to insert; taken by value so it can be sorted in place.
+	 */
+	void InsertBatch(TArray<ElementType> Batch)
+	{
+		const AlgoImpl::FPairKeyProjection Projection;
+		Batch.StableSort([this](const ElementType& A, const ElementType& B) { return Predicate(A.Key, B.Key); });
+
+		// Keep only the last pair of each run of equal keys.
+		SizeType NumUnique = 0;
+		for (SizeType Index = 0; Index < Batch.Num(); ++Index)
+		{
+			const bool bLastOfRun = Index + 1 == Batch.Num() || Predicate(Batch[Index].Key, Batch[Index + 1].Key);
+			if (bLastOfRun)
+			{
+				if (NumUnique != Index)
+				{
+					Batch[NumUnique] = MoveTempIfPossible(Batch[Index]);
+				}
+				++NumUnique;
+			}
+		}
+
+		// Update the keys which already exist, compacting the new ones to the front of the batch.
+		SizeType NumNew = 0;
+		SizeType PairIndex = 0;
+		for (SizeType Index = 0; Index < NumUnique; ++Index)
+		{
+			ElementType& Pair = Batch[Index];
+			while (PairIndex < Pairs.Num() && Predicate(Pairs[PairIndex].Key, Pair.Key))
+			{
+				++PairIndex;
+			}
+
+			if (PairIndex < Pairs.Num() && !Predicate(Pair.Key, Pairs[PairIndex].Key))
+			{
+				Pairs[PairIndex].Value = MoveTempIfPossible(Pair.Value);
+			}
+			else
+			{
+				if (NumNew != Index)
+				{
+					Batch[NumNew] = MoveTempIfPossible(Pair);
+				}
+				++NumNew;
+			}
+		}
+
+		AlgoImpl::MergeSortedBatch(Pairs, Batch.GetData(), NumNew, Projection, Predicate);
+	}
+
+	/**
+	 * Finds the value associated with a specified key.
+	 *
+	 * @return A pointer to the value, or nullptr if the key isn't contained in this map.
+	 */
+	ValueType* Find(const KeyType& Key)
+	{
+		const SizeType Index = LowerBound(Key);
+		return (Index < Pairs.Num() && !Predicate(Key, Pairs[Index].Key)) ? &Pairs[Index].Value : nullptr;
+	}
+
+	const ValueType* Find(const KeyType& Key) const
+	{
+		return const_cast<TFlatMap*>(this)->Find(Key);
+	}
+
+	/** @return The value associated with the specified key, or a default constructed value if the key isn't contained in this map. */
+	ValueType FindRef(const KeyType& Key) const
+	{
+		const ValueType* Value = Find(Key);
+		return Value ? *Value : ValueType();
+	}
+
+	bool Contains(const KeyType& Key) const
+	{
+		return Find(Key) != nullptr;
+	}
+
+	/**
+	 * Removes the pair with the given key.
+	 *
+	 * @return The number of pairs removed.
+	 */
+	SizeType Remove(const KeyType& Key)
+	{
+		const SizeType Index = LowerBound(Key);
+		if (Index < Pairs.Num() && !Predicate(Key, Pairs[Index].Key))
+		{
+			Pairs.RemoveAt(Index, 1, false);
+			return 1;
+		}
+		return 0;
+	}
+
+	/** @return the index of the first pair whose key is not less than Key. */
+	SizeType LowerBound(const KeyType& Key) const
+	{
+		return AlgoImpl::LowerBoundBranchless(Pairs.GetData(), Pairs.Num(), Key, AlgoImpl::FPairKeyProjection(), Predicate);
+	}
+
+	void Reserve(SizeType Number)
+	{
+		Pairs.Reserve(Number);
+	}
+
+	void Empty(SizeType Slack = 0)
+	{
+		Pairs.Empty(Slack);
+	}
+
+	void Reset()
+	{
+		Pairs.Reset();
+	}
+
+	SizeType Num() const
+	{
+		return Pairs.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return Pairs.IsEmpty();
+	}
+
+	/** @return the pairs in key order. */
+	const TArray<ElementType>& Array() const
+	{
+		return Pairs;
+	}
+
+private:
+	TArray<ElementType> Pairs;
+	PredicateType       Predicate;
+
+	friend const ElementType* begin(const TFlatMap& Map) { return begin(Map.Pairs); }
+	friend const ElementType* end  (const TFlatMap& Map) { return end  (Map.Pairs); }
+};
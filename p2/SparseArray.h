@@ -0,0 +1,437 @@
+#pragma once
+#include "Array.h"
+#include "BitArray.h"
+
+/**
+ * The memory of an element in a sparse array: either the element itself, or
+ * while the slot is free, a link to the next free slot.
+ */
+template <typename ElementType>
+union TSparseArrayElementOrFreeListLink
+{
+	alignas(ElementType) std::uint8_t ElementData[sizeof(ElementType)];
+
+	/** If the element isn't allocated, the index of the next free element, or INDEX_NONE. */
+	std::int32_t NextFreeIndex;
+};
+
+/**
+ * A dynamically sized array where element indices aren't necessarily contiguous. Memory is allocated for all
+ * elements in the array's index range, so it doesn't save memory; but it does allow O(1) element removal that
+ * doesn't invalidate the indices of subsequent elements. Removed slots are threaded onto a free list through
+ * their own storage and reused by the next Add.
+ *
+ * Which slots hold elements is tracked in a TBitArray; iteration scans its words and skips holes 64 at a time.
+ */
+template <typename InElementType>
+class TSparseArray
+{
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	inline const static SizeType INDEX_NONE = -1;
+
+private:
+	typedef TSparseArrayElementOrFreeListLink<ElementType> FElementOrFreeListLink;
+
+public:
+	TSparseArray()
+		: FirstFreeIndex(INDEX_NONE)
+		, NumFreeIndices(0)
+	{ }
+
+	TSparseArray(const TSparseArray& Other)
+		: FirstFreeIndex(INDEX_NONE)
+		, NumFreeIndices(0)
+	{
+		*this = Other;
+	}
+
+	TSparseArray(TSparseArray&& Other)
+		: Data(MoveTempIfPossible(Other.Data))
+		, AllocationFlags(MoveTempIfPossible(Other.AllocationFlags))
+		, FirstFreeIndex(Other.FirstFreeIndex)
+		, NumFreeIndices(Other.NumFreeIndices)
+	{
+		Other.FirstFreeIndex = INDEX_NONE;
+		Other.NumFreeIndices = 0;
+	}
+
+	~TSparseArray()
+	{
+		Empty();
+	}
+
+	TSparseArray& operator=(const TSparseArray& Other)
+	{
+		if (this != &Other)
+		{
+			Empty(Other.GetMaxIndex());
+
+			Data.AddUninitialized(Other.GetMaxIndex());
+			AllocationFlags = Other.AllocationFlags;
+			FirstFreeIndex = Other.FirstFreeIndex;
+			NumFreeIndices = Other.NumFreeIndices;
+
+			for (SizeType Index = 0; Index < Other.GetMaxIndex(); ++Index)
+			{
+				if (Other.IsAllocated(Index))
+				{
+					new(&GetElement(Index)) ElementType(Other[Index]);
+				}
+				else
+				{
+					Data[Index].NextFreeIndex = Other.Data[Index].NextFreeIndex;
+				}
+			}
+		}
+		return *this;
+	}
+
+	TSparseArray& operator=(TSparseArray&& Other)
+	{
+		if (this != &Other)
+		{
+			Empty();
+			Data = MoveTempIfPossible(Other.Data);
+			AllocationFlags = MoveTempIfPossible(Other.AllocationFlags);
+			FirstFreeIndex = Other.FirstFreeIndex;
+			NumFreeIndices = Other.NumFreeIndices;
+			Other.FirstFreeIndex = INDEX_NONE;
+			Other.NumFreeIndices = 0;
+		}
+		return *this;
+	}
+
+	/**
+	 * Allocates space for an element in the array.  The element is not initialized, and you must use the
+	 * corresponding placement new operator to construct the element in the allocated memory.
+	 *
+	 * @return The index of the allocated element.
+	 */
+	SizeType AddUninitialized()
+	{
+		SizeType Index;
+		if (NumFreeIndices)
+		{
+			// Remove and use the first index from the list of free elements.
+			Index = FirstFreeIndex;
+			FirstFreeIndex = Data[FirstFreeIndex].NextFreeIndex;
+			--NumFreeIndices;
+		}
+		else
+		{
+			// Add a new element.
+			Index = Data.AddUninitialized();
+			AllocationFlags.Add(false);
+		}
+
+		AllocationFlags[Index] = true;
+		return Index;
+	}
+
+	/**
+	 * Adds an element to the array, reusing a previously removed slot if there is one.
+	 *
+	 * @return The index of the element; it stays valid until the element is removed or the array is compacted.
+	 */
+	SizeType Add(const ElementType& Element)
+	{
+		return Emplace(Element);
+	}
+
+	SizeType Add(ElementType&& Element)
+	{
+		return Emplace(MoveTempIfPossible(Element));
+	}
+
+	/**
+	 * Constructs a new item at the first free index of the array.
+	 *
+	 * @param Args	The arguments to forward to the constructor of the new item.
+	 * @return		Index to the new item
+	 */
+	template <typename... ArgsType>
+	SizeType Emplace(ArgsType&&... Args)
+	{
+		const SizeType Index = AddUninitialized();
+		new(&GetElement(Index)) ElementType(std::forward<ArgsType>(Args)...);
+		return Index;
+	}
+
+	/** Removes the element at Index, putting its slot at the head of the free list. */
+	void RemoveAt(SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+
+		DestructItem(&GetElement(Index));
+
+		Data[Index].NextFreeIndex = NumFreeIndices ? FirstFreeIndex : INDEX_NONE;
+		FirstFreeIndex = Index;
+		++NumFreeIndices;
+		AllocationFlags[Index] = false;
+	}
+
+	/**
+	 * Removes all elements from the array, potentially leaving space allocated for an expected number of elements about to be added.
+	 *
+	 * @param ExpectedNumElements The expected number of elements about to be added.
+	 */
+	void Empty(SizeType ExpectedNumElements = 0)
+	{
+		DestructAllocatedElements();
+		Data.Empty(ExpectedNumElements);
+		AllocationFlags.Empty(ExpectedNumElements);
+		FirstFreeIndex = INDEX_NONE;
+		NumFreeIndices = 0;
+	}
+
+	/** Empties the array, but keep its allocated memory as slack. */
+	void Reset()
+	{
+		DestructAllocatedElements();
+		Data.Reset();
+		AllocationFlags.Reset();
+		FirstFreeIndex = INDEX_NONE;
+		NumFreeIndices = 0;
+	}
+
+	/** Preallocates enough memory to contain the specified number of elements. */
+	void Reserve(SizeType ExpectedNumElements)
+	{
+		Data.Reserve(ExpectedNumElements);
+		AllocationFlags.Reserve(ExpectedNumElements);
+	}
+
+	/**
+	 * Moves elements from the end of the array into the holes so that the array has no free slots, then trims the storage.
+	 * This changes the indices of the moved elements; OnMoved(OldIndex, NewIndex) is called for each of them.
+	 *
+	 * @return true if any elements were moved.
+	 */
+	template <typename CallbackType>
+	bool Compact(CallbackType&& OnMoved)
+	{
+		if (!NumFreeIndices)
+		{
+			return false;
+		}
+
+		bool bMovedAny = false;
+		const SizeType NewNum = Num();
+		SizeType FillIndex = FindNextAllocated(0, false);
+		for (SizeType SourceIndex = GetMaxIndex() - 1; FillIndex < NewNum; --SourceIndex)
+		{
+			if (!IsAllocated(SourceIndex))
+			{
+				continue;
+			}
+
+			RelocateConstructItems<ElementType>(&Data[FillIndex], &GetElement(SourceIndex), 1);
+			AllocationFlags[FillIndex] = true;
+			Invoke(OnMoved, SourceIndex, FillIndex);
+			bMovedAny = true;
+
+			FillIndex = FindNextAllocated(FillIndex + 1, false);
+		}
+
+		Data.RemoveAt(NewNum, GetMaxIndex() - NewNum, false);
+		AllocationFlags.SetNum(NewNum, false);
+		FirstFreeIndex = INDEX_NONE;
+		NumFreeIndices = 0;
+		return bMovedAny;
+	}
+
+	bool Compact()
+	{
+		return Compact([](SizeType, SizeType) {});
+	}
+
+	/** Shrinks the storage to the last allocated element; unlike Compact, indices are preserved. */
+	void Shrink()
+	{
+		SizeType MaxAllocatedIndex = GetMaxIndex() - 1;
+		while (MaxAllocatedIndex >= 0 && !IsAllocated(MaxAllocatedIndex))
+		{
+			--MaxAllocatedIndex;
+		}
+
+		const SizeType NewMaxIndex = MaxAllocatedIndex + 1;
+		if (NewMaxIndex < GetMaxIndex())
+		{
+			// Drop the trimmed slots from the free list.
+			SizeType* LinkPtr = &FirstFreeIndex;
+			for (SizeType Remaining = NumFreeIndices; Remaining; --Remaining)
+			{
+				if (*LinkPtr >= NewMaxIndex)
+				{
+					*LinkPtr = Data[*LinkPtr].NextFreeIndex;
+					--NumFreeIndices;
+				}
+				else
+				{
+					LinkPtr = &Data[*LinkPtr].NextFreeIndex;
+				}
+			}
+
+			Data.RemoveAt(NewMaxIndex, GetMaxIndex() - NewMaxIndex, false);
+			AllocationFlags.SetNum(NewMaxIndex, false);
+		}
+		Data.Shrink();
+	}
+
+	/** @return true if Index refers to an allocated element. */
+	bool IsAllocated(SizeType Index) const
+	{
+		return AllocationFlags[Index];
+	}
+
+	bool IsValidIndex(SizeType Index) const
+	{
+		return AllocationFlags.IsValidIndex(Index) && AllocationFlags[Index];
+	}
+
+	/** @return the number of elements in the array. */
+	SizeType Num() const
+	{
+		return Data.Num() - NumFreeIndices;
+	}
+
+	bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+
+	/** @return one past the highest index in use, allocated or free. */
+	SizeType GetMaxIndex() const
+	{
+		return Data.Num();
+	}
+
+	ElementType& operator[](SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		return GetElement(Index);
+	}
+
+	const ElementType& operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return const_cast<TSparseArray*>(this)->GetElement(Index);
+	}
+
+	/** @return the bit mask of allocated slots. */
+	const TBitArray& GetAllocationFlags() const
+	{
+		return AllocationFlags;
+	}
+
+private:
+	ElementType& GetElement(SizeType Index)
+	{
+		return *(ElementType*)Data[Index].ElementData;
+	}
+
+	/**
+	 * Finds the first slot at or after StartIndex whose allocation bit equals bAllocated.
+	 *
+	 * @return the index found, or GetMaxIndex() if there is none.
+	 */
+	SizeType FindNextAllocated(SizeType StartIndex, bool bAllocated = true) const
+	{
+		const SizeType Index = bAllocated ? AllocationFlags.FindNextSetBit(StartIndex) : AllocationFlags.FindNextClearBit(StartIndex);
+		return Index != INDEX_NONE ? Index : GetMaxIndex();
+	}
+
+	void DestructAllocatedElements()
+	{
+		if constexpr (!TIsTriviallyDestructible<ElementType>::Value)
+		{
+			for (SizeType Index = FindNextAllocated(0); Index < GetMaxIndex(); Index = FindNextAllocated(Index + 1))
+			{
+				DestructItem(&GetElement(Index));
+			}
+		}
+	}
+
+public:
+	/** The iterator for sparse arrays; only visits allocated elements. */
+	template <bool bConst>
+	class TBaseIterator
+	{
+		typedef std::conditional_t<bConst, const TSparseArray, TSparseArray> ArrayType;
+		typedef std::conditional_t<bConst, const ElementType, ElementType>   ItElementType;
+
+	public:
+		explicit TBaseIterator(ArrayType& InArray, SizeType StartIndex = 0)
+			: Array(InArray)
+			, Index(InArray.FindNextAllocated(StartIndex))
+		{ }
+
+		TBaseIterator& operator++()
+		{
+			Index = Array.FindNextAllocated(Index + 1);
+			return *this;
+		}
+
+		/** conversion to "bool" returning true if the iterator is valid. */
+		explicit operator bool() const
+		{
+			return Index < Array.GetMaxIndex();
+		}
+
+		SizeType GetIndex() const
+		{
+			return Index;
+		}
+
+		ItElementType& operator*() const
+		{
+			return Array[Index];
+		}
+
+		ItElementType* operator->() const
+		{
+			return &Array[Index];
+		}
+
+		/** Removes the current element from the array; the iterator can still be advanced afterwards. */
+		void RemoveCurrent()
+		{
+			static_assert(!bConst, "Cannot remove through a const iterator");
+			Array.RemoveAt(Index);
+		}
+
+		bool operator==(const TBaseIterator& Rhs) const { return Index == Rhs.Index && &Array == &Rhs.Array; }
+		bool operator!=(const TBaseIterator& Rhs) const { return !(*this == Rhs); }
+
+	private:
+		ArrayType& Array;
+		SizeType   Index;
+	};
+
+	typedef TBaseIterator<false> TIterator;
+	typedef TBaseIterator<true>  TConstIterator;
+
+	TIterator CreateIterator()
+	{
+		return TIterator(*this);
+	}
+
+	TConstIterator CreateConstIterator() const
+	{
+		return TConstIterator(*this);
+	}
+
+private:
+	TArray<FElementOrFreeListLink> Data;
+	TBitArray                      AllocationFlags;
+	SizeType                       FirstFreeIndex;
+	SizeType                       NumFreeIndices;
+
+	friend TIterator      begin(      TSparseArray& Array) { return TIterator     (Array); }
+	friend TConstIterator begin(const TSparseArray& Array) { return TConstIterator(Array); }
+	friend TIterator      end  (      TSparseArray& Array) { return TIterator     (Array, Array.GetMaxIndex()); }
+	friend TConstIterator end  (const TSparseArray& Array) { return TConstIterator(Array, Array.GetMaxIndex()); }
+};
@@ -0,0 +1,285 @@
+#pragma once
+#include <initializer_list>
+#include "Util.h"
+#include "BinaryHeap.h"
+
+/**
+ * An array with a capacity fixed at compile time and its elements stored inline, with the TArray interface.
+ *
+ * There is no heap allocation and no capacity growth: adding beyond MaxNum asserts. Everything is constexpr, so a
+ * TStaticArray can be filled, searched and sorted during constant evaluation to build lookup tables:
+ *
+ *		constexpr TStaticArray<int, 8> MakeTable()
+ *		{
+ *			TStaticArray<int, 8> Table;
+ *			for (int Index = 0; Index < 8; ++Index)
+ *			{
+ *				Table.Add(Index * Index);
+ *			}
+ *			return Table;
+ *		}
+ *		constexpr TStaticArray<int, 8> SquaresTable = MakeTable();
+ *
+ * Constant evaluation can't construct objects in raw storage, so all MaxNum elements are value-initialized up front
+ * and removal assigns over the removed slots; ElementType must be default constructible and assignable.
+ */
+template <typename InElementType, std::int32_t MaxNum>
+class TStaticArray
+{
+	static_assert(MaxNum > 0, "TStaticArray needs a capacity of at least one element");
+
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	static constexpr SizeType INDEX_NONE = -1;
+
+public:
+	constexpr TStaticArray()
+		: Data{}
+		, ArrayNum(0)
+	{ }
+
+	constexpr TStaticArray(std::initializer_list<ElementType> InitList)
+		: Data{}
+		, ArrayNum(0)
+	{
+		for (const ElementType& Element : InitList)
+		{
+			Add(Element);
+		}
+	}
+
+	constexpr ElementType* GetData()
+	{
+		return Data;
+	}
+
+	constexpr const ElementType* GetData() const
+	{
+		return Data;
+	}
+
+	constexpr SizeType Num() const
+	{
+		return ArrayNum;
+	}
+
+	static constexpr SizeType Max()
+	{
+		return MaxNum;
+	}
+
+	constexpr bool IsEmpty() const
+	{
+		return ArrayNum == 0;
+	}
+
+	constexpr bool IsFull() const
+	{
+		return ArrayNum == MaxNum;
+	}
+
+	constexpr bool IsValidIndex(SizeType Index) const
+	{
+		return Index >= 0 && Index < ArrayNum;
+	}
+
+	constexpr ElementType& operator[](SizeType Index)
+	{
+		_ASSERT(IsValidIndex(Index));
+		return Data[Index];
+	}
+
+	constexpr const ElementType& operator[](SizeType Index) const
+	{
+		_ASSERT(IsValidIndex(Index));
+		return Data[Index];
+	}
+
+	constexpr ElementType& Last(SizeType IndexFromTheEnd = 0)
+	{
+		return (*this)[ArrayNum - IndexFromTheEnd - 1];
+	}
+
+	constexpr const ElementType& Last(SizeType IndexFromTheEnd = 0) const
+	{
+		return (*this)[ArrayNum - IndexFromTheEnd - 1];
+	}
+
+	/**
+	 * Adds an element to the end of the array. The array must not be full.
+	 *
+	 * @return Index of the new element.
+	 */
+	constexpr SizeType Add(const ElementType& Item)
+	{
+		_ASSERT(ArrayNum < MaxNum);
+		Data[ArrayNum] = Item;
+		return ArrayNum++;
+	}
+
+	constexpr SizeType Add(ElementType&& Item)
+	{
+		_ASSERT(ArrayNum < MaxNum);
+		Data[ArrayNum] = std::move(Item);
+		return ArrayNum++;
+	}
+
+	template <typename... ArgsType>
+	constexpr SizeType Emplace(ArgsType&&... Args)
+	{
+		return Add(ElementType(std::forward<ArgsType>(Args)...));
+	}
+
+	/** Inserts an element at Index, shifting the following elements up. The array must not be full. */
+	constexpr SizeType Insert(const ElementType& Item, SizeType Index)
+	{
+		_ASSERT(ArrayNum < MaxNum && Index >= 0 && Index <= ArrayNum);
+		for (SizeType MoveIndex = ArrayNum; MoveIndex > Index; --MoveIndex)
+		{
+			Data[MoveIndex] = std::move(Data[MoveIndex - 1]);
+		}
+		Data[Index] = Item;
+		++ArrayNum;
+		return Index;
+	}
+
+	/** Removes Count elements at Index, shifting the following elements down to keep their order. */
+	constexpr void RemoveAt(SizeType Index, SizeType Count = 1)
+	{
+		_ASSERT(Count >= 0 && Index >= 0 && Index + Count <= ArrayNum);
+		for (SizeType MoveIndex = Index; MoveIndex + Count < ArrayNum; ++MoveIndex)
+		{
+			Data[MoveIndex] = std::move(Data[MoveIndex + Count]);
+		}
+		ClearSlots(ArrayNum - Count, ArrayNum);
+		ArrayNum -= Count;
+	}
+
+	/** Removes Count elements at Index, moving the last elements into the hole. Does not preserve order. */
+	constexpr void RemoveAtSwap(SizeType Index, SizeType Count = 1)
+	{
+		_ASSERT(Count >= 0 && Index >= 0 && Index + Count <= ArrayNum);
+		const SizeType NumToMove = ArrayNum - Index - Count < Count ? ArrayNum - Index - Count : Count;
+		for (SizeType MoveIndex = 0; MoveIndex < NumToMove; ++MoveIndex)
+		{
+			Data[Index + MoveIndex] = std::move(Data[ArrayNum - NumToMove + MoveIndex]);
+		}
+		ClearSlots(ArrayNum - Count, ArrayNum);
+		ArrayNum -= Count;
+	}
+
+	/** Removes and returns the last element. */
+	constexpr ElementType Pop()
+	{
+		_ASSERT(ArrayNum > 0);
+		ElementType Result = std::move(Data[ArrayNum - 1]);
+		RemoveAt(ArrayNum - 1);
+		return Result;
+	}
+
+	/** Removes all elements. */
+	constexpr void Reset()
+	{
+		ClearSlots(0, ArrayNum);
+		ArrayNum = 0;
+	}
+
+	constexpr void Empty()
+	{
+		Reset();
+	}
+
+	/** @return the index of the first element equal to Item, or INDEX_NONE. */
+	constexpr SizeType Find(const ElementType& Item) const
+	{
+		for (SizeType Index = 0; Index < ArrayNum; ++Index)
+		{
+			if (Data[Index] == Item)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	constexpr bool Find(const ElementType& Item, SizeType& Index) const
+	{
+		Index = Find(Item);
+		return Index != INDEX_NONE;
+	}
+
+	/** @return the index of the first element for which Pred returns true, or INDEX_NONE. */
+	template <typename Predicate>
+	constexpr SizeType IndexOfByPredicate(Predicate Pred) const
+	{
+		for (SizeType Index = 0; Index < ArrayNum; ++Index)
+		{
+			if (Pred(Data[Index]))
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	constexpr bool Contains(const ElementType& Item) const
+	{
+		return Find(Item) != INDEX_NONE;
+	}
+
+	/**
+	 * Sorts the array. Heap sort, so it works in constant evaluation, needs no extra memory and is O(N log N)
+	 * in every case; it is not stable.
+	 */
+	template <typename PredicateType>
+	constexpr void Sort(const PredicateType& Predicate)
+	{
+		AlgoImpl::HeapSortInternal<2>(Data, ArrayNum, Predicate);
+	}
+
+	constexpr void Sort()
+	{
+		Sort(TLess<ElementType>());
+	}
+
+	constexpr bool operator==(const TStaticArray& Other) const
+	{
+		if (ArrayNum != Other.ArrayNum)
+		{
+			return false;
+		}
+		for (SizeType Index = 0; Index < ArrayNum; ++Index)
+		{
+			if (!(Data[Index] == Other.Data[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const TStaticArray& Other) const
+	{
+		return !(*this == Other);
+	}
+
+private:
+	/** Resets removed slots to a value-initialized element, so they don't keep resources alive. */
+	constexpr void ClearSlots(SizeType Begin, SizeType End)
+	{
+		for (SizeType Index = Begin; Index < End; ++Index)
+		{
+			Data[Index] = ElementType();
+		}
+	}
+
+	friend constexpr       ElementType* begin(      TStaticArray& Array) { return Array.Data; }
+	friend constexpr const ElementType* begin(const TStaticArray& Array) { return Array.Data; }
+	friend constexpr       ElementType* end  (      TStaticArray& Array) { return Array.Data + Array.ArrayNum; }
+	friend constexpr const ElementType* end  (const TStaticArray& Array) { return Array.Data + Array.ArrayNum; }
+
+	ElementType Data[MaxNum];
+	SizeType    ArrayNum;
+};
\ No newline at end of file
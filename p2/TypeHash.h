@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+/**
+ * Mixes the bits of a 64-bit value so that every input bit affects every output bit.
+ * Open-addressing containers take both the slot and the control byte from the hash,
+ * so an identity hash for integers would cluster badly.
+ */
+inline std::uint64_t MixTypeHash(std::uint64_t Hash)
+{
+	// Finalizer from MurmurHash3
+	Hash ^= Hash >> 33;
+	Hash *= 0xff51afd7ed558ccdull;
+	Hash ^= Hash >> 33;
+	Hash *= 0xc4ceb9fe1a85ec53ull;
+	Hash ^= Hash >> 33;
+	return Hash;
+}
+
+/**
+ * Hash function used by the associative containers.
+ * Provide an overload of GetTypeHash in the namespace of your type to make it usable as a key.
+ */
+template <typename T>
+std::uint64_t GetTypeHash(const T& Value)
+{
+	if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+	{
+		return MixTypeHash((std::uint64_t)Value);
+	}
+	else if constexpr (std::is_pointer_v<T>)
+	{
+		return MixTypeHash((std::uint64_t)(std::uintptr_t)Value);
+	}
+	else
+	{
+		return MixTypeHash((std::uint64_t)std::hash<T>()(Value));
+	}
+}
+
+inline std::uint64_t HashCombine(std::uint64_t A, std::uint64_t B)
+{
+	return MixTypeHash(A ^ (B + 0x9e3779b97f4a7c15ull + (A << 6) + (A >> 2)));
+}
\ No newline at end of file
@@ -0,0 +1,504 @@
+#pragma once
+#include <new>
+#include "Util.h"
+
+namespace UnrolledListImpl
+{
+	/** Enough elements to fill a node of about four cache lines, and at least four. */
+	template <typename ElementType>
+	constexpr std::int32_t DefaultNodeCapacity()
+	{
+		return 256 / sizeof(ElementType) > 4 ? std::int32_t(256 / sizeof(ElementType)) : 4;
+	}
+}
+
+template <typename NodeType, typename ElementType>
+class TUnrolledListIterator
+{
+public:
+	TUnrolledListIterator(NodeType* InNode, std::int32_t InIndex)
+		: CurrentNode(InNode)
+		, CurrentIndex(InIndex)
+	{ }
+
+	/** conversion to "bool" returning true if the iterator is valid. */
+	explicit operator bool() const
+	{
+		return CurrentNode != nullptr;
+	}
+
+	TUnrolledListIterator& operator++()
+	{
+		_ASSERT(CurrentNode);
+		if (++CurrentIndex == CurrentNode->NumElements)
+		{
+			CurrentNode  = CurrentNode->NextNode;
+			CurrentIndex = 0;
+		}
+		return *this;
+	}
+
+	TUnrolledListIterator operator++(int)
+	{
+		auto Tmp = *this;
+		++(*this);
+		return Tmp;
+	}
+
+	TUnrolledListIterator& operator--()
+	{
+		_ASSERT(CurrentNode);
+		if (CurrentIndex > 0)
+		{
+			--CurrentIndex;
+		}
+		else
+		{
+			CurrentNode  = CurrentNode->PrevNode;
+			CurrentIndex = CurrentNode ? CurrentNode->NumElements - 1 : 0;
+		}
+		return *this;
+	}
+
+	TUnrolledListIterator operator--(int)
+	{
+		auto Tmp = *this;
+		--(*this);
+		return Tmp;
+	}
+
+	// Accessors.
+	ElementType* operator->() const
+	{
+		_ASSERT(CurrentNode);
+		return CurrentNode->GetData() + CurrentIndex;
+	}
+
+	ElementType& operator*() const
+	{
+		_ASSERT(CurrentNode);
+		return CurrentNode->GetData()[CurrentIndex];
+	}
+
+	NodeType* GetNode() const
+	{
+		return CurrentNode;
+	}
+
+	std::int32_t GetIndex() const
+	{
+		return CurrentIndex;
+	}
+
+	bool operator==(const TUnrolledListIterator& Rhs) const { return CurrentNode == Rhs.CurrentNode && CurrentIndex == Rhs.CurrentIndex; }
+	bool operator!=(const TUnrolledListIterator& Rhs) const { return !(*this == Rhs); }
+
+private:
+	NodeType*    CurrentNode;
+	std::int32_t CurrentIndex;
+};
+
+/**
+ * A doubly linked list whose nodes each hold up to NodeCapacity elements in a contiguous block. Traversal touches a
+ * new node (and likely a new cache line) only once per block instead of once per element, and the elements of a
+ * block can be processed in a tight loop with ForEachChunk.
+ *
+ * Inserting or removing at a known position shifts at most NodeCapacity elements, so it stays O(1). A full node is
+ * split in two halves before an insert into it, except at either end of the list, where a new node is started so
+ * that adding in sequence fills nodes completely. A node left less than half full by a removal borrows an element from
+ * a neighbour, or merges with it if the neighbour is at half itself.
+ *
+ * Elements are moved within and between nodes with a bitwise relocation, like TArray does. Inserting or removing
+ * invalidates iterators into the nodes involved.
+ */
+template <typename InElementType, std::int32_t NodeCapacity = UnrolledListImpl::DefaultNodeCapacity<InElementType>()>
+class TUnrolledList
+{
+	static_assert(NodeCapacity >= 2, "Nodes must be able to hold at least two elements");
+
+public:
+	typedef InElementType ElementType;
+	typedef std::int32_t  SizeType;
+
+	class FNode
+	{
+	public:
+		ElementType* GetData()
+		{
+			return (ElementType*)Storage;
+		}
+
+		const ElementType* GetData() const
+		{
+			return (const ElementType*)Storage;
+		}
+
+		SizeType Num() const
+		{
+			return NumElements;
+		}
+
+		FNode* GetNextNode() const
+		{
+			return NextNode;
+		}
+
+		FNode* GetPrevNode() const
+		{
+			return PrevNode;
+		}
+
+	private:
+		friend class TUnrolledList;
+		template <typename, typename> friend class TUnrolledListIterator;
+
+		FNode*   NextNode;
+		FNode*   PrevNode;
+		SizeType NumElements;
+		alignas(ElementType) unsigned char Storage[sizeof(ElementType) * NodeCapacity];
+	};
+
+	typedef TUnrolledListIterator<FNode,       ElementType> TIterator;
+	typedef TUnrolledListIterator<FNode, const ElementType> TConstIterator;
+
+	/** Elements are kept at least this full in every node which has a neighbour, once they have been removed from. */
+	static constexpr SizeType MinElementsPerNode = NodeCapacity / 2;
+
+	TUnrolledList()
+		: HeadNode(nullptr)
+		, TailNode(nullptr)
+		, ListSize(0)
+	{ }
+
+	~TUnrolledList()
+	{
+		Empty();
+	}
+
+	TUnrolledList(const TUnrolledList&) = delete;
+	TUnrolledList& operator=(const TUnrolledList&) = delete;
+
+	// Adding/Removing methods
+
+	/** Adds an element at the beginning of the list. */
+	ElementType& AddHead(const ElementType& InElement)
+	{
+		if (!HeadNode || HeadNode->NumElements == NodeCapacity)
+		{
+			LinkNodeAfter(AllocateNode(), nullptr);
+		}
+		return *InsertIntoNode(HeadNode, 0, InElement);
+	}
+
+	/** Adds an element at the end of the list. */
+	ElementType& AddTail(const ElementType& InElement)
+	{
+		if (!TailNode || TailNode->NumElements == NodeCapacity)
+		{
+			LinkNodeAfter(AllocateNode(), TailNode);
+		}
+		return *InsertIntoNode(TailNode, TailNode->NumElements, InElement);
+	}
+
+	ElementType& Add(const ElementType& InElement)
+	{
+		return AddTail(InElement);
+	}
+
+	/**
+	 * Inserts an element before the one Before points at, or at the end of the list if Before is the end.
+	 *
+	 * @return an iterator to the new element.
+	 */
+	TIterator Insert(TIterator Before, const ElementType& InElement)
+	{
+		FNode*   Node  = Before.GetNode();
+		SizeType Index = Before.GetIndex();
+		if (!Node)
+		{
+			AddTail(InElement);
+			return TIterator(TailNode, TailNode->NumElements - 1);
+		}
+		if (Node == HeadNode && Index == 0)
+		{
+			AddHead(InElement);
+			return TIterator(HeadNode, 0);
+		}
+
+		if (Node->NumElements == NodeCapacity)
+		{
+			FNode* NewNode = SplitNode(Node);
+			if (Index > Node->NumElements)
+			{
+				Index -= Node->NumElements;
+				Node = NewNode;
+			}
+		}
+		InsertIntoNode(Node, Index, InElement);
+		return TIterator(Node, Index);
+	}
+
+	/**
+	 * Removes the element Position points at.
+	 *
+	 * @return an iterator to the element after it.
+	 */
+	TIterator Remove(TIterator Position)
+	{
+		FNode*   Node  = Position.GetNode();
+		SizeType Index = Position.GetIndex();
+		_ASSERT(Node && Index < Node->NumElements);
+
+		ElementType* Data = Node->GetData();
+		DestructItem(Data + Index);
+		RelocateConstructItems<ElementType>(Data + Index, Data + Index + 1, Node->NumElements - Index - 1);
+		--Node->NumElements;
+		--ListSize;
+
+		if (Node->NumElements == 0)
+		{
+			FNode* Next = Node->NextNode;
+			UnlinkAndFreeNode(Node);
+			return TIterator(Next, 0);
+		}
+
+		if (Node->NumElements < MinElementsPerNode)
+		{
+			Rebalance(Node, Index);
+		}
+		return Index < Node->NumElements ? TIterator(Node, Index) : TIterator(Node->NextNode, 0);
+	}
+
+	/** Removes the first element. */
+	void RemoveHead()
+	{
+		Remove(TIterator(HeadNode, 0));
+	}
+
+	/** Removes the last element. */
+	void RemoveTail()
+	{
+		_ASSERT(TailNode);
+		Remove(TIterator(TailNode, TailNode->NumElements - 1));
+	}
+
+	/** Removes all elements and frees every node. */
+	void Empty()
+	{
+		while (HeadNode)
+		{
+			FNode* Next = HeadNode->NextNode;
+			DestructItems(HeadNode->GetData(), HeadNode->NumElements);
+			FreeNode(HeadNode);
+			HeadNode = Next;
+		}
+		TailNode = nullptr;
+		ListSize = 0;
+	}
+
+	// Accessors.
+
+	ElementType& First()
+	{
+		_ASSERT(HeadNode);
+		return HeadNode->GetData()[0];
+	}
+
+	const ElementType& First() const
+	{
+		_ASSERT(HeadNode);
+		return HeadNode->GetData()[0];
+	}
+
+	ElementType& Last()
+	{
+		_ASSERT(TailNode);
+		return TailNode->GetData()[TailNode->NumElements - 1];
+	}
+
+	const ElementType& Last() const
+	{
+		_ASSERT(TailNode);
+		return TailNode->GetData()[TailNode->NumElements - 1];
+	}
+
+	FNode* GetHead() const
+	{
+		return HeadNode;
+	}
+
+	FNode* GetTail() const
+	{
+		return TailNode;
+	}
+
+	/** @return an iterator to the first element equal to InElement, or the end. */
+	TIterator Find(const ElementType& InElement)
+	{
+		for (FNode* Node = HeadNode; Node; Node = Node->NextNode)
+		{
+			const ElementType* Data = Node->GetData();
+			for (SizeType Index = 0; Index < Node->NumElements; ++Index)
+			{
+				if (Data[Index] == InElement)
+				{
+					return TIterator(Node, Index);
+				}
+			}
+		}
+		return TIterator(nullptr, 0);
+	}
+
+	bool Contains(const ElementType& InElement)
+	{
+		return (bool)Find(InElement);
+	}
+
+	/**
+	 * Calls Func(ElementType* Data, SizeType Count) for the block of elements in every node, in order. Faster than
+	 * the iterators for long traversals, as the inner loop over a block is a plain array loop.
+	 */
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func)
+	{
+		for (FNode* Node = HeadNode; Node; Node = Node->NextNode)
+		{
+			Func(Node->GetData(), Node->NumElements);
+		}
+	}
+
+	template <typename FuncType>
+	void ForEachChunk(FuncType&& Func) const
+	{
+		for (const FNode* Node = HeadNode; Node; Node = Node->NextNode)
+		{
+			Func(Node->GetData(), Node->NumElements);
+		}
+	}
+
+	bool IsEmpty() const
+	{
+		return ListSize == 0;
+	}
+
+	SizeType Num() const
+	{
+		return ListSize;
+	}
+
+private:
+	static FNode* AllocateNode()
+	{
+		static_assert(alignof(ElementType) <= 16, "Elements aligned beyond 16 bytes are not supported");
+
+		void* Data = nullptr;
+		ResizeAllocation(Data, 0, 1, sizeof(FNode), &GetMemoryTypeTag<TUnrolledList>());
+		FNode* Node = (FNode*)Data;
+		Node->NextNode = Node->PrevNode = nullptr;
+		Node->NumElements = 0;
+		return Node;
+	}
+
+	static void FreeNode(FNode* Node)
+	{
+		void* Data = Node;
+		ResizeAllocation(Data, 1, 0, sizeof(FNode), &GetMemoryTypeTag<TUnrolledList>());
+	}
+
+	/** Links Node in after Prev, or at the head if Prev is nullptr. */
+	void LinkNodeAfter(FNode* Node, FNode* Prev)
+	{
+		FNode* Next = Prev ? Prev->NextNode : HeadNode;
+		Node->PrevNode = Prev;
+		Node->NextNode = Next;
+		(Prev ? Prev->NextNode : HeadNode) = Node;
+		(Next ? Next->PrevNode : TailNode) = Node;
+	}
+
+	void UnlinkAndFreeNode(FNode* Node)
+	{
+		(Node->PrevNode ? Node->PrevNode->NextNode : HeadNode) = Node->NextNode;
+		(Node->NextNode ? Node->NextNode->PrevNode : TailNode) = Node->PrevNode;
+		FreeNode(Node);
+	}
+
+	ElementType* InsertIntoNode(FNode* Node, SizeType Index, const ElementType& InElement)
+	{
+		_ASSERT(Node->NumElements < NodeCapacity && Index <= Node->NumElements);
+		ElementType* Data = Node->GetData();
+		RelocateConstructItems<ElementType>(Data + Index + 1, Data + Index, Node->NumElements - Index);
+		new(Data + Index) ElementType(InElement);
+		++Node->NumElements;
+		++ListSize;
+		return Data + Index;
+	}
+
+	/** Moves the upper half of Node's elements into a new node after it, and returns the new node. */
+	FNode* SplitNode(FNode* Node)
+	{
+		FNode* NewNode = AllocateNode();
+		const SizeType NumToMove = Node->NumElements / 2;
+		const SizeType NumToKeep = Node->NumElements - NumToMove;
+		RelocateConstructItems<ElementType>(NewNode->GetData(), Node->GetData() + NumToKeep, NumToMove);
+		NewNode->NumElements = NumToMove;
+		Node->NumElements = NumToKeep;
+		LinkNodeAfter(NewNode, Node);
+		return NewNode;
+	}
+
+	/**
+	 * Refills a node which dropped below MinElementsPerNode from a neighbour, preferring the next one. Index is the
+	 * position of the element after the removed one, and is updated to where that element ends up.
+	 */
+	void Rebalance(FNode*& Node, SizeType& Index)
+	{
+		if (FNode* Next = Node->NextNode)
+		{
+			if (Next->NumElements > MinElementsPerNode)
+			{
+				// Borrow the next node's first element.
+				RelocateConstructItems<ElementType>(Node->GetData() + Node->NumElements, Next->GetData(), 1);
+				RelocateConstructItems<ElementType>(Next->GetData(), Next->GetData() + 1, Next->NumElements - 1);
+				++Node->NumElements;
+				--Next->NumElements;
+			}
+			else
+			{
+				// Merge the next node into this one.
+				RelocateConstructItems<ElementType>(Node->GetData() + Node->NumElements, Next->GetData(), Next->NumElements);
+				Node->NumElements += Next->NumElements;
+				UnlinkAndFreeNode(Next);
+			}
+		}
+		else if (FNode* Prev = Node->PrevNode)
+		{
+			if (Prev->NumElements > MinElementsPerNode)
+			{
+				// Borrow the previous node's last element.
+				RelocateConstructItems<ElementType>(Node->GetData() + 1, Node->GetData(), Node->NumElements);
+				RelocateConstructItems<ElementType>(Node->GetData(), Prev->GetData() + Prev->NumElements - 1, 1);
+				++Node->NumElements;
+				--Prev->NumElements;
+				++Index;
+			}
+			else
+			{
+				// Merge this node into the previous one.
+				RelocateConstructItems<ElementType>(Prev->GetData() + Prev->NumElements, Node->GetData(), Node->NumElements);
+				Index += Prev->NumElements;
+				Prev->NumElements += Node->NumElements;
+				UnlinkAndFreeNode(Node);
+				Node = Prev;
+			}
+		}
+	}
+
+	FNode*   HeadNode;
+	FNode*   TailNode;
+	SizeType ListSize;
+
+	friend TIterator      begin(      TUnrolledList& List) { return TIterator     (List.HeadNode, 0); }
+	friend TConstIterator begin(const TUnrolledList& List) { return TConstIterator(List.HeadNode, 0); }
+	friend TIterator      end  (      TUnrolledList&     ) { return TIterator     (nullptr, 0); }
+	friend TConstIterator end  (const TUnrolledList&     ) { return TConstIterator(nullptr, 0); }
+};
\ No newline at end of file
@@ -3,6 +3,38 @@
 #include <type_traits>
 #include <cstdlib>
 #include <string>
+#include "Memory.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__AVX__)
+	#define UTIL_USE_AVX_STREAMING 1
+	#include <immintrin.h>
+#else
+	#define UTIL_USE_AVX_STREAMING 0
+#endif
+
+/**
+ * Copies and fills of at least this many bytes are written with non-temporal stores, which go around the cache:
+ * a block that big would evict everything else, and the writer is rarely the next one to read all of it.
+ */
+#ifndef UTIL_STREAMING_THRESHOLD_BYTES
+	#define UTIL_STREAMING_THRESHOLD_BYTES (4 * 1024 * 1024)
+#endif
+
+/** Streaming copies and fills of at least UTIL_STREAMING_PARALLEL_THRESHOLD_BYTES are split across up to this many threads. */
+#ifndef UTIL_STREAMING_MAX_THREADS
+	#define UTIL_STREAMING_MAX_THREADS 1
+#endif
+
+#ifndef UTIL_STREAMING_PARALLEL_THRESHOLD_BYTES
+	#define UTIL_STREAMING_PARALLEL_THRESHOLD_BYTES (64 * 1024 * 1024)
+#endif
+
+#if UTIL_STREAMING_MAX_THREADS > 1
+	#include <thread>
+#endif
 
 /**
  * TIsReferenceType
@@ -81,6 +113,137 @@ template <> struct TIsBitwiseConstructible< std::int32_t, std::uint32_t> { enum
 template <> struct TIsBitwiseConstructible<std::uint64_t, std::int64_t>  { enum { Value = true }; };
 template <> struct TIsBitwiseConstructible< std::int64_t, std::uint64_t> { enum { Value = true }; };
 
+namespace MemoryImpl
+{
+#if UTIL_USE_AVX_STREAMING
+	/** Copies Count bytes with 32-byte non-temporal stores. Ordinary copies handle the unaligned head and the tail. */
+	inline void StreamingMemcpy(void* Dest, const void* Src, std::size_t Count)
+	{
+		std::uint8_t* DestBytes = (std::uint8_t*)Dest;
+		const std::uint8_t* SrcBytes = (const std::uint8_t*)Src;
+
+		const std::size_t HeadCount = (32 - ((std::uintptr_t)DestBytes & 31)) & 31;
+		memcpy(DestBytes, SrcBytes, HeadCount);
+		DestBytes += HeadCount;
+		SrcBytes += HeadCount;
+		Count -= HeadCount;
+
+		for (; Count >= 128; Count -= 128, DestBytes += 128, SrcBytes += 128)
+		{
+			const __m256i A = _mm256_loadu_si256((const __m256i*)(SrcBytes +  0));
+			const __m256i B = _mm256_loadu_si256((const __m256i*)(SrcBytes + 32));
+			const __m256i C = _mm256_loadu_si256((const __m256i*)(SrcBytes + 64));
+			const __m256i D = _mm256_loadu_si256((const __m256i*)(SrcBytes + 96));
+			_mm256_stream_si256((__m256i*)(DestBytes +  0), A);
+			_mm256_stream_si256((__m256i*)(DestBytes + 32), B);
+			_mm256_stream_si256((__m256i*)(DestBytes + 64), C);
+			_mm256_stream_si256((__m256i*)(DestBytes + 96), D);
+		}
+		for (; Count >= 32; Count -= 32, DestBytes += 32, SrcBytes += 32)
+		{
+			_mm256_stream_si256((__m256i*)DestBytes, _mm256_loadu_si256((const __m256i*)SrcBytes));
+		}
+		memcpy(DestBytes, SrcBytes, Count);
+
+		// Non-temporal stores are weakly ordered; make them visible before anything written after the copy.
+		_mm_sfence();
+	}
+
+	/** Zeroes Count bytes with 32-byte non-temporal stores. */
+	inline void StreamingMemzero(void* Dest, std::size_t Count)
+	{
+		std::uint8_t* DestBytes = (std::uint8_t*)Dest;
+
+		const std::size_t HeadCount = (32 - ((std::uintptr_t)DestBytes & 31)) & 31;
+		memset(DestBytes, 0, HeadCount);
+		DestBytes += HeadCount;
+		Count -= HeadCount;
+
+		const __m256i Zero = _mm256_setzero_si256();
+		for (; Count >= 128; Count -= 128, DestBytes += 128)
+		{
+			_mm256_stream_si256((__m256i*)(DestBytes +  0), Zero);
+			_mm256_stream_si256((__m256i*)(DestBytes + 32), Zero);
+			_mm256_stream_si256((__m256i*)(DestBytes + 64), Zero);
+			_mm256_stream_si256((__m256i*)(DestBytes + 96), Zero);
+		}
+		for (; Count >= 32; Count -= 32, DestBytes += 32)
+		{
+			_mm256_stream_si256((__m256i*)DestBytes, Zero);
+		}
+		memset(DestBytes, 0, Count);
+
+		_mm_sfence();
+	}
+
+	/** Runs Func(Offset, Count) over [0, TotalCount) split into slices, on up to UTIL_STREAMING_MAX_THREADS threads. */
+	template <typename FuncType>
+	void ForEachStreamingSlice(std::size_t TotalCount, const FuncType& Func)
+	{
+#if UTIL_STREAMING_MAX_THREADS > 1
+		if (TotalCount >= UTIL_STREAMING_PARALLEL_THRESHOLD_BYTES)
+		{
+			// Keep every slice past the threshold at which streaming pays off, and cache-line aligned.
+			std::size_t NumSlices = TotalCount / UTIL_STREAMING_THRESHOLD_BYTES;
+			NumSlices = NumSlices < UTIL_STREAMING_MAX_THREADS ? NumSlices : UTIL_STREAMING_MAX_THREADS;
+			const std::size_t SliceCount = (TotalCount / NumSlices) & ~std::size_t(63);
+
+			std::thread Threads[UTIL_STREAMING_MAX_THREADS - 1];
+			for (std::size_t SliceIndex = 1; SliceIndex < NumSlices; ++SliceIndex)
+			{
+				const std::size_t Offset = SliceIndex * SliceCount;
+				const std::size_t Count  = SliceIndex + 1 < NumSlices ? SliceCount : TotalCount - Offset;
+				Threads[SliceIndex - 1] = std::thread(Func, Offset, Count);
+			}
+			Func(std::size_t(0), SliceCount);
+			for (std::size_t SliceIndex = 1; SliceIndex < NumSlices; ++SliceIndex)
+			{
+				Threads[SliceIndex - 1].join();
+			}
+			return;
+		}
+#endif
+		Func(std::size_t(0), TotalCount);
+	}
+#endif
+}
+
+/**
+ * memcpy for blocks of any size: blocks of at least UTIL_STREAMING_THRESHOLD_BYTES are copied with non-temporal
+ * stores (when AVX is available) so they don't flush the cache, and split across threads if configured.
+ * The ranges must not overlap.
+ */
+inline void* BigBlockMemcpy(void* Dest, const void* Src, std::size_t Count)
+{
+#if UTIL_USE_AVX_STREAMING
+	if (Count >= UTIL_STREAMING_THRESHOLD_BYTES)
+	{
+		MemoryImpl::ForEachStreamingSlice(Count, [Dest, Src](std::size_t Offset, std::size_t SliceCount)
+		{
+			MemoryImpl::StreamingMemcpy((std::uint8_t*)Dest + Offset, (const std::uint8_t*)Src + Offset, SliceCount);
+		});
+		return Dest;
+	}
+#endif
+	return memcpy(Dest, Src, Count);
+}
+
+/** memset to zero for blocks of any size; see BigBlockMemcpy. */
+inline void* BigBlockMemzero(void* Dest, std::size_t Count)
+{
+#if UTIL_USE_AVX_STREAMING
+	if (Count >= UTIL_STREAMING_THRESHOLD_BYTES)
+	{
+		MemoryImpl::ForEachStreamingSlice(Count, [Dest](std::size_t Offset, std::size_t SliceCount)
+		{
+			MemoryImpl::StreamingMemzero((std::uint8_t*)Dest + Offset, SliceCount);
+		});
+		return Dest;
+	}
+#endif
+	return memset(Dest, 0, Count);
+}
+
 template <typename DestinationElementType, typename SourceElementType, typename SizeType>
 void ConstructItems(void* Dest, const SourceElementType* Source, SizeType Count)
 {
@@ -88,7 +251,7 @@ void ConstructItems(void* Dest, const SourceElementType* Source, SizeType Count)
 	{
 		if (Count)
 		{
-			memcpy(Dest, Source, sizeof(SourceElementType) * Count);
+			BigBlockMemcpy(Dest, Source, sizeof(SourceElementType) * Count);
 		}
 	}
 	else
@@ -220,7 +383,16 @@ void RelocateConstructItems(void* Dest, const SourceElementType* Source, SizeTyp
 		 * However, it is not yet possible to automatically infer this at compile time, so we can't enable
 		 * different (i.e. safer) implementations anyway. */
 
-		memmove(Dest, Source, sizeof(SourceElementType) * Count);
+		const std::size_t NumBytes = sizeof(SourceElementType) * Count;
+		const bool bOverlapping = (std::uint8_t*)Dest < (const std::uint8_t*)Source + NumBytes && (const std::uint8_t*)Source < (std::uint8_t*)Dest + NumBytes;
+		if (bOverlapping)
+		{
+			memmove(Dest, Source, NumBytes);
+		}
+		else
+		{
+			BigBlockMemcpy(Dest, Source, NumBytes);
+		}
 	}
 	else
 	{
@@ -237,9 +409,9 @@ void RelocateConstructItems(void* Dest, const SourceElementType* Source, SizeTyp
 	}
 }
 
-static void* Memzero(void* Dest, size_t Count)
+inline void* Memzero(void* Dest, size_t Count)
 {
-	return memset( Dest, 0, Count );
+	return BigBlockMemzero(Dest, Count);
 }
 
 template <typename FuncType, typename... ArgTypes>
@@ -249,7 +421,12 @@ auto Invoke(FuncType&& Func, ArgTypes&&... Args)
 	return std::forward<FuncType>(Func)(std::forward<ArgTypes>(Args)...);
 }
 
-void ResizeAllocation(void*& Data, std::size_t PreviousNumElements, std::size_t NumElements, std::size_t NumBytesPerElement)
+/**
+ * Resizes a container allocation through the memory layer (see Memory.h).
+ *
+ * @param TypeTag Tag of the calling container type, so its allocations can be told apart in memory reports.
+ */
+inline void ResizeAllocation(void*& Data, std::size_t PreviousNumElements, std::size_t NumElements, std::size_t NumBytesPerElement, FMemoryTag* TypeTag = nullptr)
 {
 	// Avoid calling FMemory::Realloc( nullptr, 0 ) as ANSI C mandates returning a valid pointer which is not what we want.
 	if (NumElements)
@@ -260,12 +437,11 @@ void ResizeAllocation(void*& Data, std::size_t PreviousNumElements, std::size_t
 			return;
 		}
 
-		void* NewRealloc = ::realloc(Data, NumElements*NumBytesPerElement);
-		Data = NewRealloc;
+		Data = FMemory::Realloc(Data, NumElements*NumBytesPerElement, TypeTag);
 	}
 	else
 	{
-		::free(Data);
+		FMemory::Free(Data);
 		Data = nullptr;
 	}
 }
@@ -333,3 +509,119 @@ typename std::remove_reference<T>::type&& MoveTempIfPossible(T&& Obj)
 	typedef typename std::remove_reference<T>::type CastType;
 	return (CastType&&)Obj;
 }
+
+
+/**
+ * Counts the number of trailing zeros in the bit representation of the value.
+ *
+ * @param	Value	the value to determine the number of trailing zeros for; must not be zero.
+ * @return	the number of zeros after the least significant set bit.
+ */
+inline std::uint32_t CountTrailingZeros(std::uint32_t Value)
+{
+	_ASSERT(Value != 0);
+#if defined(_MSC_VER)
+	unsigned long BitIndex;
+	_BitScanForward(&BitIndex, Value);
+	return BitIndex;
+#else
+	return (std::uint32_t)__builtin_ctz(Value);
+#endif
+}
+
+/**
+ * Counts the number of trailing zeros in the bit representation of the 64-bit value.
+ *
+ * @param	Value	the value to determine the number of trailing zeros for; must not be zero.
+ * @return	the number of zeros after the least significant set bit.
+ */
+inline std::uint32_t CountTrailingZeros64(std::uint64_t Value)
+{
+	_ASSERT(Value != 0);
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long BitIndex;
+	_BitScanForward64(&BitIndex, Value);
+	return BitIndex;
+#elif defined(_MSC_VER)
+	const std::uint32_t Low = (std::uint32_t)Value;
+	return Low ? CountTrailingZeros(Low) : 32 + CountTrailingZeros((std::uint32_t)(Value >> 32));
+#else
+	return (std::uint32_t)__builtin_ctzll(Value);
+#endif
+}
+
+/**
+ * Computes the base 2 logarithm of the value, rounded down.
+ *
+ * @param	Value	the value to take the logarithm of; must not be zero.
+ * @return	the index of the most significant set bit.
+ */
+inline std::uint32_t FloorLog2(std::uint32_t Value)
+{
+	_ASSERT(Value != 0);
+#if defined(_MSC_VER)
+	unsigned long BitIndex;
+	_BitScanReverse(&BitIndex, Value);
+	return BitIndex;
+#else
+	return 31 - (std::uint32_t)__builtin_clz(Value);
+#endif
+}
+
+/**
+ * Computes the base 2 logarithm of the 64-bit value, rounded down.
+ *
+ * @param	Value	the value to take the logarithm of; must not be zero.
+ * @return	the index of the most significant set bit.
+ */
+inline std::uint32_t FloorLog2_64(std::uint64_t Value)
+{
+	_ASSERT(Value != 0);
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long BitIndex;
+	_BitScanReverse64(&BitIndex, Value);
+	return BitIndex;
+#elif defined(_MSC_VER)
+	const std::uint32_t High = (std::uint32_t)(Value >> 32);
+	return High ? 32 + FloorLog2(High) : FloorLog2((std::uint32_t)Value);
+#else
+	return 63 - (std::uint32_t)__builtin_clzll(Value);
+#endif
+}
+
+/**
+ * Counts the number of set bits in the 64-bit value.
+ */
+inline std::uint32_t CountBits64(std::uint64_t Value)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	return (std::uint32_t)__popcnt64(Value);
+#elif defined(_MSC_VER)
+	return (std::uint32_t)(__popcnt((std::uint32_t)Value) + __popcnt((std::uint32_t)(Value >> 32)));
+#else
+	return (std::uint32_t)__builtin_popcountll(Value);
+#endif
+}
+
+
+/**
+ * Binary predicate class for sorting elements in order.  Assumes < operator is defined for the template type.
+ */
+template <typename T = void>
+struct TLess
+{
+	constexpr bool operator()(const T& A, const T& B) const
+	{
+		return A < B;
+	}
+};
+
+template <>
+struct TLess<void>
+{
+	template <typename T, typename U>
+	constexpr bool operator()(T&& A, U&& B) const
+	{
+		return std::forward<T>(A) < std::forward<U>(B);
+	}
+};
\ No newline at end of file
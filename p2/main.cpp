@@ -1,6 +1,32 @@
 #include "Array.h"
 #include "List.h"
+#include "IntrusiveList.h"
+#include "UnrolledList.h"
+#include "Map.h"
+#include "SparseArray.h"
+#include "ChunkedArray.h"
+#include "SoAArray.h"
+#include "SortedArray.h"
+#include "PriorityQueue.h"
+#include "ArraySerialization.h"
+#include "ConcurrentAppendArray.h"
+#include "SharedArray.h"
+#include "PersistentVector.h"
+#include "Pipeline.h"
+#include "StaticArray.h"
+#include "Cache.h"
+#include "LockFreeQueue.h"
+#include "SkipList.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <random>
 #include <iostream>
+#include <unordered_map>
+#include <filesystem>
+#include <string>
+#include <cstddef>
 
 class A
 {
@@ -66,8 +92,907 @@ void ListTest()
 	list1.Empty();
 }
 
+void MapTest()
+{
+	TMap<int, int> map1;
+	map1.Reserve(16);
+	map1.Add(1, 10);
+	map1.Add(2, 20);
+	map1.FindOrAdd(3) = 30;
+	map1.Remove(2);
+	std::cout << map1.Contains(2) << " " << map1.FindRef(3) << std::endl;
+
+	for (auto& Pair : map1)
+	{
+		std::cout << Pair.Key << ": " << Pair.Value << std::endl;
+	}
+}
+
+/** Set to 1 to add the 100M key run to MapBenchmark; it needs several GB of memory. */
+#ifndef MAP_BENCHMARK_100M
+#define MAP_BENCHMARK_100M 0
+#endif
+
+/** Times adding every key, finding every key, finding as many absent keys, and removing every key; prints ns per operation. */
+template <typename AddFuncType, typename FindFuncType, typename RemoveFuncType>
+void MapBenchmarkRun(const char* name, const TArray<std::uint32_t>& keys, const TArray<std::uint32_t>& missingKeys, AddFuncType&& add, FindFuncType&& find, RemoveFuncType&& remove)
+{
+	auto measure = [&keys](auto&& func)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / keys.Num();
+	};
+
+	long long numFound = 0;
+	const double addTime = measure([&]() { for (std::uint32_t key : keys) { add(key); } });
+	const double findTime = measure([&]() { for (std::uint32_t key : keys) { numFound += find(key); } });
+	const double missTime = measure([&]() { for (std::uint32_t key : missingKeys) { numFound += find(key); } });
+	const double removeTime = measure([&]() { for (std::uint32_t key : keys) { remove(key); } });
+
+	std::cout << name << " " << keys.Num() << " keys: add " << addTime << "ns, find " << findTime << "ns, miss "
+		<< missTime << "ns, remove " << removeTime << "ns " << (numFound == keys.Num()) << std::endl;
+}
+
+void MapBenchmark()
+{
+	TArray<int> sizes;
+	sizes.Add(1000);
+	sizes.Add(1000000);
+	if (MAP_BENCHMARK_100M)
+	{
+		sizes.Add(100000000);
+	}
+
+	for (int numKeys : sizes)
+	{
+		// Multiplying by an odd constant is a bijection on 32 bits, so these are distinct, scattered keys.
+		TArray<std::uint32_t> keys, missingKeys;
+		keys.Reserve(numKeys);
+		missingKeys.Reserve(numKeys);
+		for (int i = 0; i < numKeys; i++)
+		{
+			keys.Add((std::uint32_t)i * 2654435761u);
+			missingKeys.Add((std::uint32_t)(i + numKeys) * 2654435761u);
+		}
+
+		{
+			TMap<std::uint32_t, std::uint32_t> map;
+			map.Reserve(numKeys);
+			MapBenchmarkRun("TMap", keys, missingKeys,
+				[&map](std::uint32_t key) { map.Add(key, key); },
+				[&map](std::uint32_t key) { return map.Find(key) != nullptr; },
+				[&map](std::uint32_t key) { map.Remove(key); });
+		}
+		{
+			std::unordered_map<std::uint32_t, std::uint32_t> map;
+			map.reserve(numKeys);
+			MapBenchmarkRun("std::unordered_map", keys, missingKeys,
+				[&map](std::uint32_t key) { map.emplace(key, key); },
+				[&map](std::uint32_t key) { return map.find(key) != map.end(); },
+				[&map](std::uint32_t key) { map.erase(key); });
+		}
+	}
+}
+
+void SparseArrayTest()
+{
+	TSparseArray<int> arr;
+	int index1 = arr.Add(1);
+	int index2 = arr.Add(2);
+	arr.Add(3);
+	arr.RemoveAt(index2);
+	int index4 = arr.Add(4); // reuses the slot of 2
+	std::cout << index1 << " " << index4 << " " << arr[index1] << std::endl;
+
+	arr.RemoveAt(index1);
+	arr.Compact();
+	for (int Value : arr)
+	{
+		std::cout << Value << std::endl;
+	}
+}
+
+void BitArrayTest()
+{
+	TBitArray visible(false, 100);
+	TBitArray selected(false, 100);
+	visible[3] = true;
+	visible[70] = true;
+	selected[70] = true;
+	selected[99] = true;
+
+	visible.CombineWithBitwiseAND(selected);
+	std::cout << visible.CountSetBits() << " " << selected.FindFirstClearBit() << std::endl;
+
+	for (TBitArray::TConstSetBitIterator It(selected); It; ++It)
+	{
+		std::cout << It.GetIndex() << std::endl;
+	}
+}
+
+void ChunkedArrayTest()
+{
+	TChunkedArray<int, 64> arr;
+	arr.Add(1);
+	int* first = &arr[0];
+	for (int i = 2; i <= 100; i++)
+	{
+		arr.Add(i);
+	}
+	std::cout << (first == &arr[0]) << " " << arr.NumChunks() << std::endl;
+
+	int sum = 0;
+	arr.ForEachChunk([&sum](const int* Data, int Num)
+	{
+		for (int i = 0; i < Num; i++)
+		{
+			sum += Data[i];
+		}
+	});
+	std::cout << sum << std::endl;
+}
+
+void SoAArrayTest()
+{
+	TSoAArray<int, float> arr;
+	arr.Add(1, 0.5f);
+	arr.Add(2, 1.5f);
+	arr.Add(3, 2.5f);
+	arr.RemoveAtSwap(0);
+
+	for (float& Value : arr.GetField<1>())
+	{
+		Value *= 2;
+	}
+	std::cout << arr[0].Get<0>() << " " << arr[0].Get<1>() << std::endl;
+}
+
+void FlatMapTest()
+{
+	TFlatMap<int, int> map1;
+	map1.Add(5, 50);
+
+	TArray<TPair<int, int>> batch;
+	batch.Emplace(3, 30);
+	batch.Emplace(1, 10);
+	batch.Emplace(5, 55);
+	map1.InsertBatch(MoveTempIfPossible(batch));
+
+	for (auto& Pair : map1)
+	{
+		std::cout << Pair.Key << ": " << Pair.Value << std::endl;
+	}
+}
+
+void HeapTest()
+{
+	TArray<int> heap;
+	heap.HeapPush(5);
+	heap.HeapPush(1);
+	heap.HeapPush(3);
+	int top = 0;
+	heap.HeapPop(top);
+	std::cout << top << " " << heap.HeapTop() << std::endl;
+
+	TPriorityQueue<int> queue;
+	auto handle = queue.Push(10);
+	queue.Push(20);
+	queue.Update(handle, 30); // 20 is now on top
+	std::cout << queue.Pop() << " " << queue.Pop() << std::endl;
+}
+
+void SerializationTest()
+{
+	TArray<float> values;
+	for (int i = 0; i < 1000; i++)
+	{
+		values.Add(i * 0.5f);
+	}
+	const std::string path = (std::filesystem::temp_directory_path() / "values.bin").string();
+	SaveArray(values, path.c_str());
+
+	TArray<float> loaded;
+	LoadArray(loaded, path.c_str());
+
+	{
+		TMappedArrayView<float> mapped;
+		if (mapped.Open(path.c_str()))
+		{
+			std::cout << loaded.Num() << " " << mapped.GetView()[999] << std::endl;
+		}
+	}
+
+	// A header claiming far more elements than the file holds is rejected before anything is allocated for them.
+	if (std::FILE* file = std::fopen(path.c_str(), "r+b"))
+	{
+		const std::uint64_t hugeNum = INT32_MAX;
+		std::fseek(file, offsetof(FArrayFileHeader, Num), SEEK_SET);
+		std::fwrite(&hugeNum, sizeof(hugeNum), 1, file);
+		std::fclose(file);
+	}
+	std::cout << "truncated file loads: " << LoadArray(loaded, path.c_str()) << " " << loaded.Num() << std::endl;
+
+	std::remove(path.c_str());
+}
+
+void ConcurrentAppendArrayTest()
+{
+	// Contention check: every thread appends the same number of items.
+	const int itemsPerThread = 100000;
+	for (int numThreads = 1; numThreads <= 64; numThreads *= 2)
+	{
+		TConcurrentAppendArray<int> results;
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numThreads; t++)
+		{
+			threads.emplace_back([&results, t, itemsPerThread]()
+			{
+				for (int i = 0; i < itemsPerThread; i++)
+				{
+					results.Add(t * itemsPerThread + i);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		TArray<int> all = results.Consolidate();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << numThreads << " threads: " << all.Num() << " items in " << elapsed.count() << "us" << std::endl;
+	}
+}
+
+void SharedArrayTest()
+{
+	TArray<int> config;
+	config.Add(1);
+	config.Add(2);
+
+	TSharedArray<int> shared = TSharedArray<int>::Freeze(MoveTempIfPossible(config));
+	TSharedArray<int> snapshot = shared;
+	shared.Add(3); // shared gets its own copy here
+	std::cout << snapshot.Num() << " " << shared.Num() << std::endl;
+}
+
+void PersistentVectorTest()
+{
+	TPersistentVector<int> v0;
+	TPersistentVector<int> v1 = v0.Push(1).Push(2);
+	TPersistentVector<int> v2 = v1.Set(0, 10); // v1 is unchanged
+
+	TPersistentVector<int>::FTransient builder = v2.Transient();
+	for (int i = 0; i < 100; i++)
+	{
+		builder.Push(i);
+	}
+	TPersistentVector<int> v3 = builder.Persistent();
+	std::cout << v1[0] << " " << v2[0] << " " << v3.Num() << std::endl;
+}
+
+void PipelineTest()
+{
+	TArray<int> values;
+	for (int i = 0; i < 100; i++)
+	{
+		values.Add(i);
+	}
+
+	TArray<int> squares = Pipeline::From(values)
+		.Filter([](int v) { return v % 2 == 0; })
+		.Transform([](int v) { return v * v; })
+		.Take(5)
+		.ToArray();
+
+	TArray<int> doubled = Pipeline::From(values)
+		.Transform([](int v) { return v * 2; })
+		.Parallel()
+		.ToArray();
+	// Take has to tell the sink stopping a search apart from running out of values to take.
+	const bool bFoundInFirstFive = Pipeline::From(values).Take(5).Any([](int v) { return v == 3; });
+	const bool bFoundPastFirstFive = Pipeline::From(values).Take(5).Any([](int v) { return v == 7; });
+	int firstOver2 = -1;
+	const bool bFoundFirst = Pipeline::From(values).Take(5).FindFirst([](int v) { return v > 2; }, firstOver2);
+	int firstOver10 = -1;
+	const bool bFoundFirstPastTake = Pipeline::From(values).Take(5).FindFirst([](int v) { return v > 10; }, firstOver10);
+	std::cout << squares[4] << " " << doubled[99] << ", take+any " << bFoundInFirstFive << " " << bFoundPastFirstFive
+		<< ", take+find first " << bFoundFirst << " " << firstOver2 << " " << bFoundFirstPastTake << std::endl;
+}
+
+constexpr TStaticArray<int, 10> MakeSquares()
+{
+	TStaticArray<int, 10> squares;
+	for (int i = 9; i >= 0; i--)
+	{
+		squares.Add(i * i);
+	}
+	squares.Sort();
+	return squares;
+}
+
+void StaticArrayTest()
+{
+	constexpr TStaticArray<int, 10> squares = MakeSquares();
+	static_assert(squares.Find(49) == 7, "built at compile time");
+	std::cout << squares.Num() << " " << squares[9] << std::endl;
+}
+
+void BigBlockCopyTest()
+{
+	// Sizes at and past the streaming threshold, misaligned ones included, copied and zeroed to and from misaligned
+	// addresses, so the ordinary head and tail copies around the streamed middle get checked too. Every result is
+	// compared, guard bytes and all, with memcpy/memset doing the same.
+	const std::size_t sizes[] = { UTIL_STREAMING_THRESHOLD_BYTES, UTIL_STREAMING_THRESHOLD_BYTES + 77, 2 * UTIL_STREAMING_THRESHOLD_BYTES + 33 };
+	const std::size_t offsets[] = { 0, 1, 31 };
+	const std::size_t guardBytes = 64;
+
+	std::vector<std::uint8_t> source(2 * UTIL_STREAMING_THRESHOLD_BYTES + 33 + 2 * guardBytes);
+	std::mt19937 random(39);
+	for (std::uint8_t& byte : source)
+	{
+		byte = (std::uint8_t)random();
+	}
+
+	bool bMatches = true;
+	std::vector<std::uint8_t> dest, expected;
+	for (std::size_t size : sizes)
+	{
+		for (std::size_t destOffset : offsets)
+		{
+			for (std::size_t sourceOffset : { std::size_t(0), std::size_t(7) })
+			{
+				dest.assign(size + 2 * guardBytes, 0xAA);
+				expected = dest;
+				bMatches &= BigBlockMemcpy(dest.data() + destOffset, source.data() + sourceOffset, size) == dest.data() + destOffset;
+				memcpy(expected.data() + destOffset, source.data() + sourceOffset, size);
+				bMatches &= dest == expected;
+			}
+
+			bMatches &= BigBlockMemzero(dest.data() + destOffset, size) == dest.data() + destOffset;
+			memset(expected.data() + destOffset, 0, size);
+			bMatches &= dest == expected;
+		}
+	}
+	std::cout << "big block copy (streaming " << UTIL_USE_AVX_STREAMING << "): matches memcpy/memset " << bMatches << std::endl;
+}
+
+void MemoryReportTest()
+{
+	{
+		MEMORY_SCOPE("MemoryReportTest");
+		TArray<int> values;
+		for (int i = 0; i < 1000; i++)
+		{
+			values.Add(i);
+		}
+	}
+	FMemory::DumpReport();
+}
+
+template <typename ListType>
+void ListChurn(const char* name)
+{
+	const auto start = std::chrono::steady_clock::now();
+	ListType list;
+	for (int round = 0; round < 1000; round++)
+	{
+		for (int i = 0; i < 1000; i++)
+		{
+			list.AddTail(i);
+		}
+		while (list.Num() > 100)
+		{
+			list.RemoveNode(list.GetHead());
+		}
+	}
+	list.Empty();
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	std::cout << name << ": " << elapsed.count() << "us" << std::endl;
+}
+
+void ListPoolTest()
+{
+	ListChurn<TDoubleLinkedList<int>>("new/delete");
+	ListChurn<TDoubleLinkedList<int, TListNodePoolAllocator<>>>("pool");
+	ListChurn<TDoubleLinkedList<int, TThreadCachedListNodeAllocator<>>>("thread cached pool");
+}
+
+struct FPooledRequest
+{
+	int id;
+	FIntrusiveListLink pendingLink;
+};
+
+void IntrusiveListTest()
+{
+	FPooledRequest requests[4] = { { 1, {} }, { 2, {} }, { 3, {} }, { 4, {} } };
+	TIntrusiveDoubleLinkedList<FPooledRequest, &FPooledRequest::pendingLink> pending;
+	for (FPooledRequest& request : requests)
+	{
+		pending.AddTail(request);
+	}
+
+	// A request can take itself out of the list without knowing about it.
+	requests[1].pendingLink.Unlink();
+
+	for (auto It = begin(pending); It; ++It)
+	{
+		std::cout << It->id << " ";
+	}
+	std::cout << "(" << pending.Num() << " pending)" << std::endl;
+}
+
+/** Skewed keys: squaring a uniform value makes small keys much more likely, like a hot set in a real workload. */
+int SkewedKey(std::mt19937& random, int numKeys)
+{
+	const double uniform = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+	return (int)(uniform * uniform * uniform * numKeys);
+}
+
+template <typename CacheType>
+void CacheBenchmark(const char* name)
+{
+	const int numKeys = 100000;
+	const int numLookups = 1000000;
+	CacheType cache(numKeys / 20);
+	std::mt19937 random(42);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < numLookups; i++)
+	{
+		const int key = SkewedKey(random, numKeys);
+		if (!cache.Find(key))
+		{
+			cache.Add(key, key);
+		}
+	}
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	std::cout << name << ": hit rate " << cache.GetStats().GetHitRate() << ", " << numLookups * 1000000.0 / elapsed.count() << " lookups/s" << std::endl;
+}
+
+void CacheTest()
+{
+	CacheBenchmark<TLruCache<int, int>>("LRU");
+	CacheBenchmark<TLfuCache<int, int>>("LFU");
+
+	// The same workload from several threads through a sharded cache.
+	const int lookupsPerThread = 250000;
+	for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+	{
+		TShardedCache<TLruCache<int, int>> cache(5000);
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numThreads; t++)
+		{
+			threads.emplace_back([&cache, t, lookupsPerThread]()
+			{
+				std::mt19937 random(t);
+				for (int i = 0; i < lookupsPerThread; i++)
+				{
+					int value;
+					const int key = SkewedKey(random, 100000);
+					if (!cache.Find(key, value))
+					{
+						cache.Add(key, key);
+					}
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		std::cout << "sharded LRU, " << numThreads << " threads: hit rate " << cache.GetStats().GetHitRate() << ", "
+			<< numThreads * lookupsPerThread * 1000000.0 / elapsed.count() << " lookups/s" << std::endl;
+	}
+}
+
+void UnrolledListTest()
+{
+	const int numElements = 1000000;
+	TUnrolledList<int> unrolled;
+	for (int i = 0; i < numElements; i++)
+	{
+		unrolled.AddTail(i);
+	}
+
+	// Scatter the linked list's nodes the way a long-running program's churn would: free a node-sized block for each
+	// element in random order, so the list reuses them in that order.
+	TDoubleLinkedList<int> list;
+	TArray<int*> blocks;
+	for (int i = 0; i < numElements; i++)
+	{
+		blocks.Add(new int[6]);
+	}
+	std::mt19937 random(7);
+	for (int i = numElements - 1; i > 0; i--)
+	{
+		std::swap(blocks[i], blocks[random() % (i + 1)]);
+	}
+	for (int* block : blocks)
+	{
+		delete[] block;
+	}
+	for (int i = 0; i < numElements; i++)
+	{
+		list.AddTail(i);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	long long listSum = 0;
+	for (auto It = TDoubleLinkedList<int>::TConstIterator(list.GetHead()); It; ++It)
+	{
+		listSum += *It;
+	}
+	const auto listTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	start = std::chrono::steady_clock::now();
+	long long unrolledSum = 0;
+	for (int value : unrolled)
+	{
+		unrolledSum += value;
+	}
+	const auto unrolledTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	start = std::chrono::steady_clock::now();
+	long long chunkSum = 0;
+	unrolled.ForEachChunk([&chunkSum](const int* data, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			chunkSum += data[i];
+		}
+	});
+	const auto chunkTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	std::cout << "list: " << listTime.count() << "us, unrolled: " << unrolledTime.count() << "us, unrolled chunks: "
+		<< chunkTime.count() << "us " << (listSum == unrolledSum && unrolledSum == chunkSum) << std::endl;
+
+	// Insert and remove in the middle as well, with small nodes so that they split, borrow and merge often, and check
+	// the order both ways against a TArray given the same operations.
+	typedef TUnrolledList<int, 8> FSmallUnrolledList;
+	FSmallUnrolledList small;
+	TArray<int> expected;
+	auto checkOrder = [&small, &expected]()
+	{
+		bool bOrdered = small.Num() == expected.Num();
+		int index = 0;
+		for (int value : small)
+		{
+			bOrdered &= index < expected.Num() && value == expected[index++];
+		}
+		if (small.GetTail())
+		{
+			for (auto It = FSmallUnrolledList::TIterator(small.GetTail(), small.GetTail()->Num() - 1); It; --It)
+			{
+				bOrdered &= index > 0 && *It == expected[--index];
+			}
+		}
+		return bOrdered && index == 0;
+	};
+
+	std::mt19937 ops(11);
+	bool bOrdered = true;
+	for (int round = 0; round < 20000; round++)
+	{
+		// Mostly inserts for the first half, then mostly removes.
+		const bool bInsert = expected.Num() == 0 || (int)(ops() % 100) < (round < 10000 ? 70 : 30);
+		const int index = (int)(ops() % (expected.Num() + bInsert));
+		auto It = begin(small);
+		for (int i = 0; i < index; i++)
+		{
+			++It;
+		}
+
+		if (bInsert)
+		{
+			bOrdered &= *small.Insert(It, round) == round;
+			expected.Insert(round, index);
+		}
+		else
+		{
+			It = small.Remove(It);
+			expected.RemoveAt(index);
+			bOrdered &= index < expected.Num() ? It && *It == expected[index] : !It;
+		}
+
+		if (round % 1000 == 999)
+		{
+			bOrdered &= checkOrder();
+		}
+	}
+	std::cout << "unrolled list middle inserts/removes: " << small.Num() << " left, ordered " << bOrdered << std::endl;
+}
+
+void ListRelinkTest()
+{
+	TDoubleLinkedList<int> odds, evens;
+	for (int i : { 9, 3, 7, 1, 5 })
+	{
+		odds.AddTail(i);
+	}
+	for (int i : { 8, 2, 6, 4 })
+	{
+		evens.AddTail(i);
+	}
+
+	odds.Sort();
+	evens.Sort();
+	odds.Merge(evens);
+	odds.Reverse();
+
+	// Move the three largest values to the end.
+	odds.Splice(nullptr, odds, odds.GetHead(), odds.GetHead()->GetNextNode()->GetNextNode(), 3);
+
+	for (int value : odds)
+	{
+		std::cout << value << " ";
+	}
+	std::cout << "(" << odds.Num() << " nodes, " << evens.Num() << " left in evens)" << std::endl;
+}
+
+/** The baseline the lock-free queues replace: a TDoubleLinkedList behind a mutex. */
+class FMutexListQueue
+{
+public:
+	void Enqueue(long long value)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		list.AddTail(value);
+	}
+
+	bool Dequeue(long long& outValue)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto* head = list.GetHead();
+		if (!head)
+		{
+			return false;
+		}
+		outValue = head->GetValue();
+		list.RemoveNode(head);
+		return true;
+	}
+
+private:
+	std::mutex mutex;
+	TDoubleLinkedList<long long> list;
+};
+
+long long NowNanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Runs numProducers threads enqueueing itemsPerProducer items each and numConsumers threads dequeueing them. Every item
+ * carries its enqueue time, so the consumers can measure how long it waited in the queue. A producer waits
+ * intervalNanoseconds after each item, or enqueues flat out if it is 0.
+ *
+ * @return the elapsed time in microseconds.
+ */
+template <typename QueueType>
+long long RunQueueBenchmark(int numProducers, int numConsumers, int itemsPerProducer, long long intervalNanoseconds, TArray<long long>& outLatencies)
+{
+	const int numItems = numProducers * itemsPerProducer;
+	QueueType queue;
+	std::atomic<int> numConsumed(0);
+	TArray<TArray<long long>> latencies;
+	for (int c = 0; c < numConsumers; c++)
+	{
+		latencies.Emplace();
+		latencies[c].Reserve(numItems);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int p = 0; p < numProducers; p++)
+	{
+		threads.emplace_back([&queue, itemsPerProducer, intervalNanoseconds]()
+		{
+			for (int i = 0; i < itemsPerProducer; i++)
+			{
+				queue.Enqueue(NowNanoseconds());
+				if (intervalNanoseconds > 0)
+				{
+					// Wait from the last enqueue rather than catch up with a schedule, so a late producer doesn't burst.
+					const long long next = NowNanoseconds() + intervalNanoseconds;
+					while (NowNanoseconds() < next)
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+		});
+	}
+	for (int c = 0; c < numConsumers; c++)
+	{
+		TArray<long long>* consumerLatencies = &latencies[c];
+		threads.emplace_back([&queue, &numConsumed, consumerLatencies, numItems]()
+		{
+			long long enqueueTime;
+			while (numConsumed.load(std::memory_order_relaxed) < numItems)
+			{
+				if (queue.Dequeue(enqueueTime))
+				{
+					consumerLatencies->Add(NowNanoseconds() - enqueueTime);
+					numConsumed.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	for (TArray<long long>& consumerLatencies : latencies)
+	{
+		for (long long latency : consumerLatencies)
+		{
+			outLatencies.Add(latency);
+		}
+	}
+	outLatencies.Sort();
+	return elapsed.count();
+}
+
+/**
+ * Measures throughput with the producers enqueueing flat out, and latency separately with them paced to one item every
+ * 20us each: flat out, the queue builds up a backlog and the latencies would mostly measure how long that is.
+ */
+template <typename QueueType>
+void QueueBenchmark(const char* name, int numProducers, int numConsumers)
+{
+	const int itemsPerProducer = 50000;
+	TArray<long long> backlogLatencies;
+	const long long elapsed = RunQueueBenchmark<QueueType>(numProducers, numConsumers, itemsPerProducer, 0, backlogLatencies);
+
+	TArray<long long> all;
+	RunQueueBenchmark<QueueType>(numProducers, numConsumers, 5000, 20000, all);
+	std::cout << name << " " << numProducers << "P/" << numConsumers << "C: " << numProducers * itemsPerProducer * 1000000.0 / elapsed << " items/s, paced latency p50 "
+		<< all[all.Num() / 2] << "ns p99 " << all[all.Num() * 99 / 100] << "ns p99.9 " << all[all.Num() * 999 / 1000] << "ns" << std::endl;
+}
+
+void LockFreeQueueTest()
+{
+	for (int numProducers = 1; numProducers <= 4; numProducers *= 2)
+	{
+		QueueBenchmark<FMutexListQueue>("mutex list", numProducers, 1);
+		QueueBenchmark<TMpscQueue<long long>>("MPSC queue", numProducers, 1);
+		QueueBenchmark<FMutexListQueue>("mutex list", numProducers, 2);
+		QueueBenchmark<TMpmcQueue<long long>>("MPMC queue", numProducers, 2);
+	}
+}
+
+void SkipListTest()
+{
+	TSkipList<int, int> skipList;
+	std::mt19937 random(3);
+	for (int i = 0; i < 200000; i++)
+	{
+		const int key = random() % 1000000;
+		skipList.Add(key, i);
+	}
+	for (int key = 0; key < 1000000; key += 3)
+	{
+		skipList.Remove(key);
+	}
+
+	// The bottom level is in key order both ways.
+	bool bOrdered = true;
+	for (auto* node = skipList.GetHead(); node && node->GetNextNode(); node = node->GetNextNode())
+	{
+		bOrdered &= node->GetValue().Key < node->GetNextNode()->GetValue().Key;
+	}
+	int numBackwards = 0;
+	for (auto It = TSkipList<int, int>::TConstIterator(skipList.GetTail()); It; --It)
+	{
+		numBackwards++;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	int numFound = 0;
+	for (int key = 0; key < 1000000; key++)
+	{
+		numFound += skipList.Contains(key);
+	}
+	const auto findTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	long long rangeSum = 0;
+	const int numInRange = skipList.ForEachInRange(500000, 501000, [&rangeSum](const TSkipList<int, int>::ElementType& element)
+	{
+		rangeSum += element.Key;
+	});
+
+	std::cout << "skip list: " << skipList.Num() << " keys, ordered " << bOrdered << ", backwards " << (numBackwards == skipList.Num())
+		<< ", 1M lookups " << findTime.count() << "us (" << numFound << " found), [500000, 501000): " << numInRange << " keys" << std::endl;
+}
+
+void ListEmplaceTest()
+{
+	// Heavyweight elements: 64KB buffers, built up front and handed to the list.
+	const int numBuffers = 2000;
+	TArray<TArray<std::uint8_t>> buffers;
+	for (int i = 0; i < numBuffers; i++)
+	{
+		TArray<std::uint8_t>& buffer = buffers[buffers.Emplace()];
+		buffer.AddZeroed(65536);
+		buffer[0] = (std::uint8_t)i;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	TDoubleLinkedList<TArray<std::uint8_t>> copied;
+	for (int i = 0; i < numBuffers; i++)
+	{
+		copied.AddTail(buffers[i]);
+	}
+	const auto copyTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	start = std::chrono::steady_clock::now();
+	TDoubleLinkedList<TArray<std::uint8_t>> moved;
+	for (int i = 0; i < numBuffers; i++)
+	{
+		moved.EmplaceTail(MoveTempIfPossible(buffers[i]));
+	}
+	const auto moveTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	// Move-only elements, and popping values back out without a copy.
+	TDoubleLinkedList<std::unique_ptr<int>> owners;
+	owners.EmplaceTail(new int(1));
+	owners.AddTail(std::make_unique<int>(2));
+	owners.EmplaceBefore(owners.GetTail(), new int(3));
+	const std::unique_ptr<int> last = owners.PopTail();
+
+	int numDrained = 0;
+	while (!moved.IsEmpty())
+	{
+		TArray<std::uint8_t> buffer = moved.PopHead();
+		numDrained += buffer.Num() == 65536;
+	}
+
+	std::cout << "list copy: " << copyTime.count() << "us, emplace: " << moveTime.count() << "us, drained " << numDrained
+		<< ", owners " << owners.Num() << " last " << *last << std::endl;
+}
+
 int main()
 {
 	ArrayTest();
 	ListTest();
+	MapTest();
+	MapBenchmark();
+	SparseArrayTest();
+	BitArrayTest();
+	ChunkedArrayTest();
+	SoAArrayTest();
+	FlatMapTest();
+	HeapTest();
+	SerializationTest();
+	ConcurrentAppendArrayTest();
+	SharedArrayTest();
+	PersistentVectorTest();
+	PipelineTest();
+	StaticArrayTest();
+	BigBlockCopyTest();
+	MemoryReportTest();
+	ListPoolTest();
+	IntrusiveListTest();
+	CacheTest();
+	UnrolledListTest();
+	ListRelinkTest();
+	LockFreeQueueTest();
+	SkipListTest();
+	ListEmplaceTest();
 }
\ No newline at end of file